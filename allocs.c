@@ -0,0 +1,144 @@
+/**
+ * Implementation of the functions related to counting heap allocations.
+ *
+ * The wrappers forward to glibc's own allocator (__libc_malloc and
+ * friends), so they must not allocate themselves. free is not wrapped:
+ * only the allocations matter.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <ctype.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include "allocs.h"
+
+#ifdef COUNT_ALLOCATIONS
+// Allocations made so far by every thread (malloc can't take parameters)
+atomic_ulong allocationCount = 0;
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+
+
+/**
+ * @brief Allocates memory, counting the allocation.
+ *
+ * @param size Number of bytes to allocate.
+ * @return Pointer to the allocated memory, or NULL.
+ */
+void* malloc(size_t size){
+    atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+
+/**
+ * @brief Allocates zeroed memory, counting the allocation.
+ *
+ * @param count Number of elements to allocate.
+ * @param size Size of each element.
+ * @return Pointer to the allocated memory, or NULL.
+ */
+void* calloc(size_t count, size_t size){
+    atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+
+/**
+ * @brief Resizes memory, counting the allocation.
+ *
+ * @param pointer Pointer to the memory to resize, or NULL.
+ * @param size New number of bytes.
+ * @return Pointer to the resized memory, or NULL.
+ */
+void* realloc(void* pointer, size_t size){
+    atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+    return __libc_realloc(pointer, size);
+}
+#endif
+
+
+/**
+ * @brief Checks if allocations are being counted.
+ *
+ * @return 1 if built with COUNT_ALLOCATIONS, 0 otherwise.
+ */
+int countingAllocations(){
+#ifdef COUNT_ALLOCATIONS
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief Retrieves the number of allocations made so far.
+ *
+ * @return The number of allocations, or 0 if they are not being counted.
+ */
+unsigned long getAllocationCount(){
+#ifdef COUNT_ALLOCATIONS
+    return atomic_load_explicit(&allocationCount, memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+
+/**
+ * @brief Initializes the allocation statistics, with no commands.
+ *
+ * @param stats Pointer to the statistics.
+ */
+void initAllocationStats(AllocationStats* stats){
+    memset(stats, 0, sizeof(AllocationStats));
+}
+
+
+/**
+ * @brief Adds the allocations of a command to the statistics.
+ *
+ * @param stats Pointer to the statistics.
+ * @param command The command letter.
+ * @param allocations The allocations made by the command.
+ */
+void recordAllocations(AllocationStats* stats, char command,
+unsigned long allocations){
+    unsigned int letter = (unsigned char)command % NUM_COMMAND_LETTERS;
+
+    stats->commands[letter]++;
+    stats->allocating[letter] += allocations > 0;
+    stats->allocations[letter] += allocations;
+    if (allocations > stats->maxAllocations[letter]){
+        stats->maxAllocations[letter] = allocations;
+    }
+}
+
+
+/**
+ * @brief Writes the allocations by command letter as a table.
+ *
+ * A command whose allocations only grow its structures allocates in a few
+ * of its runs: "allocating" stays far below "commands".
+ *
+ * @param stats Pointer to the statistics.
+ * @param file Where to write the table.
+ */
+void writeAllocationStats(const AllocationStats* stats, FILE* file){
+    fprintf(file, "%-8s %12s %12s %12s %8s\n", "command", "commands",
+            "allocating", "allocations", "max");
+
+    for (unsigned int i = 0; i < NUM_COMMAND_LETTERS; i++){
+        if (stats->commands[i] == 0){
+            continue;
+        }
+        fprintf(file, "%-8c %12lu %12lu %12lu %8lu\n",
+                isprint(i) ? (int)i : '?', stats->commands[i],
+                stats->allocating[i], stats->allocations[i],
+                stats->maxAllocations[i]);
+    }
+}
@@ -0,0 +1,37 @@
+/**
+ * Definition of the allocation statistics struct, and of the function
+ * prototypes related to counting heap allocations.
+ *
+ * When built with -DCOUNT_ALLOCATIONS, malloc, calloc and realloc are
+ * wrapped to count the allocations of every thread, and the allocations
+ * made by each command are aggregated by command letter. Otherwise no
+ * allocation is counted and the wrappers don't exist.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef ALLOCS_H
+#define ALLOCS_H
+
+#include <stdio.h>
+
+// Number of distinct command letters (the first char of a command)
+#define NUM_COMMAND_LETTERS 128
+
+typedef struct allocationStats {
+    unsigned long commands[NUM_COMMAND_LETTERS]; // commands run, by letter
+    unsigned long allocating[NUM_COMMAND_LETTERS]; // of them, that allocated
+    unsigned long allocations[NUM_COMMAND_LETTERS]; // total allocations
+    unsigned long maxAllocations[NUM_COMMAND_LETTERS]; // most by one command
+} AllocationStats;
+
+
+// Counting
+int countingAllocations();
+unsigned long getAllocationCount();
+
+// Statistics by command
+void initAllocationStats(AllocationStats* stats);
+void recordAllocations(AllocationStats* stats, char command,
+                        unsigned long allocations);
+void writeAllocationStats(const AllocationStats* stats, FILE* file);
+#endif
@@ -0,0 +1,262 @@
+/**
+ * Implementation of the functions related to the availability index.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "availability.h"
+#include "park.h"
+
+
+/**
+ * @brief Initializes an empty availability index.
+ *
+ * @param index Pointer to the availability index.
+ */
+void initAvailabilityIndex(AvailabilityIndex* index){
+    index->highest = NULL;
+    index->spare = NULL;
+}
+
+
+/**
+ * @brief Frees a list of buckets linked by lower.
+ *
+ * @param bucket Pointer to the first bucket.
+ */
+void freeBuckets(AvailabilityBucket* bucket){
+    while (bucket != NULL){
+        AvailabilityBucket* lower = bucket->lower;
+        free(bucket);
+        bucket = lower;
+    }
+}
+
+
+/**
+ * @brief Frees the buckets of an availability index (not the parks).
+ *
+ * @param index Pointer to the availability index.
+ */
+void freeAvailabilityIndex(AvailabilityIndex* index){
+    freeBuckets(index->highest);
+    freeBuckets(index->spare);
+    initAvailabilityIndex(index);
+}
+
+
+/**
+ * @brief Creates a bucket linked between two others, reusing a spare one
+ * if there's any.
+ *
+ * @param index Pointer to the availability index.
+ * @param availableSpots The available spots of the bucket.
+ * @param higher Pointer to the bucket with more spots, or NULL.
+ * @param lower Pointer to the bucket with less spots, or NULL.
+ * @return Pointer to the new bucket.
+ */
+AvailabilityBucket* insertBucket(AvailabilityIndex* index, int availableSpots,
+AvailabilityBucket* higher, AvailabilityBucket* lower){
+    AvailabilityBucket* bucket = index->spare;
+
+    if (bucket != NULL){
+        index->spare = bucket->lower;
+    }
+    else {
+        bucket = (AvailabilityBucket*)malloc(sizeof(AvailabilityBucket));
+    }
+    bucket->availableSpots = availableSpots;
+    bucket->first = NULL;
+    bucket->last = NULL;
+    bucket->higher = higher;
+    bucket->lower = lower;
+
+    if (higher != NULL)
+        higher->lower = bucket;
+    else
+        index->highest = bucket;
+    if (lower != NULL)
+        lower->higher = bucket;
+    return bucket;
+}
+
+
+/**
+ * @brief Appends a park to a bucket.
+ *
+ * @param bucket Pointer to the bucket.
+ * @param park Pointer to the park.
+ */
+void appendToBucket(AvailabilityBucket* bucket, Park* park){
+    park->bucket = bucket;
+    park->nextAvailable = NULL;
+    park->prevAvailable = bucket->last;
+    if (bucket->last != NULL)
+        bucket->last->nextAvailable = park;
+    else
+        bucket->first = park;
+    bucket->last = park;
+}
+
+
+/**
+ * @brief Takes a park out of its bucket, making the bucket spare if it
+ * becomes empty.
+ *
+ * @param index Pointer to the availability index.
+ * @param park Pointer to the park.
+ */
+void detachFromBucket(AvailabilityIndex* index, Park* park){
+    AvailabilityBucket* bucket = park->bucket;
+
+    if (park->prevAvailable != NULL)
+        park->prevAvailable->nextAvailable = park->nextAvailable;
+    else
+        bucket->first = park->nextAvailable;
+    if (park->nextAvailable != NULL)
+        park->nextAvailable->prevAvailable = park->prevAvailable;
+    else
+        bucket->last = park->prevAvailable;
+    park->bucket = NULL;
+
+    if (bucket->first != NULL){
+        return;
+    }
+    if (bucket->higher != NULL)
+        bucket->higher->lower = bucket->lower;
+    else
+        index->highest = bucket->lower;
+    if (bucket->lower != NULL)
+        bucket->lower->higher = bucket->higher;
+    bucket->lower = index->spare;
+    index->spare = bucket;
+}
+
+
+/**
+ * @brief Finds (or creates) the bucket of a number of spots, searching
+ * from a bucket towards the fewer or the more spots.
+ *
+ * @param index Pointer to the availability index.
+ * @param from Pointer to the bucket where the search starts, or NULL to
+ * start from the highest one.
+ * @param availableSpots The available spots of the bucket.
+ * @return Pointer to the bucket.
+ */
+AvailabilityBucket* findBucket(AvailabilityIndex* index,
+AvailabilityBucket* from, int availableSpots){
+    // Start between from and the bucket above it
+    AvailabilityBucket* lower = from != NULL ? from : index->highest;
+    AvailabilityBucket* higher = from != NULL ? from->higher : NULL;
+
+    // Go up while the bucket above doesn't have more spots
+    while (higher != NULL && higher->availableSpots <= availableSpots){
+        lower = higher;
+        higher = higher->higher;
+    }
+    // Go down while the bucket below has more spots
+    while (lower != NULL && lower->availableSpots > availableSpots){
+        higher = lower;
+        lower = lower->lower;
+    }
+
+    if (lower != NULL && lower->availableSpots == availableSpots){
+        return lower;
+    }
+    return insertBucket(index, availableSpots, higher, lower);
+}
+
+
+/**
+ * @brief Adds a park to the availability index.
+ *
+ * @param index Pointer to the availability index.
+ * @param park Pointer to the park.
+ */
+void indexPark(AvailabilityIndex* index, Park* park){
+    appendToBucket(findBucket(index, NULL, *getAvailableSpots(park)), park);
+}
+
+
+/**
+ * @brief Moves a park to the bucket of a number of available spots.
+ *
+ * Constant time when the spots changed by one, as after an entry/exit.
+ *
+ * @param index Pointer to the availability index.
+ * @param park Pointer to the park (already in the index).
+ * @param availableSpots The park's available spots.
+ */
+void updateAvailability(AvailabilityIndex* index, Park* park,
+int availableSpots){
+    AvailabilityBucket* bucket = park->bucket;
+
+    if (bucket->availableSpots == availableSpots){
+        return;
+    }
+
+    // Search from a neighbour if the bucket is about to become spare
+    AvailabilityBucket* from = bucket;
+    if (bucket->first == park && bucket->last == park){
+        int up = availableSpots > bucket->availableSpots;
+        from = up ? bucket->higher : bucket->lower;
+        if (from == NULL){
+            from = up ? bucket->lower : bucket->higher;
+        }
+    }
+    detachFromBucket(index, park);
+    appendToBucket(findBucket(index, from, availableSpots), park);
+}
+
+
+/**
+ * @brief Removes a park from the availability index.
+ *
+ * @param index Pointer to the availability index.
+ * @param park Pointer to the park (already in the index).
+ */
+void unindexPark(AvailabilityIndex* index, Park* park){
+    detachFromBucket(index, park);
+}
+
+
+/**
+ * @brief Finds the park with the most available spots.
+ *
+ * Among parks with as many spots, the one that got them first.
+ *
+ * @param index Pointer to the availability index.
+ * @return Pointer to the park, or NULL if there are no parks.
+ */
+Park* mostAvailablePark(const AvailabilityIndex* index){
+    return index->highest != NULL ? index->highest->first : NULL;
+}
+
+
+/**
+ * @brief Prints the parks with at least some available spots, from the
+ * most spots to the fewest.
+ *
+ * Prints each park's name, capacity and available spots, as printParks.
+ *
+ * @param index Pointer to the availability index.
+ * @param minimum The least available spots of the parks printed.
+ * @return The number of parks printed.
+ */
+int printParksWithSpots(const AvailabilityIndex* index, int minimum){
+    int count = 0;
+
+    for (AvailabilityBucket* bucket = index->highest;
+            bucket != NULL && bucket->availableSpots >= minimum;
+            bucket = bucket->lower){
+        for (Park* park = bucket->first; park != NULL;
+                park = park->nextAvailable){
+            printf("%s %d %d\n", getParkName(park), *getCapacity(park),
+                    *getAvailableSpots(park));
+            count++;
+        }
+    }
+
+    return count;
+}
@@ -0,0 +1,47 @@
+/**
+ * Definition of the availability index structs, and of the function
+ * prototypes related to them.
+ *
+ * The availability index keeps the parks in buckets by their number of
+ * available spots, the buckets linked from the most available spots to the
+ * least. An entry/exit changes a park's spots by one, so the park moves to
+ * a neighbouring bucket in constant time, and the parks with the most spots
+ * (or with at least some spots) are found without looking at the others.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef AVAILABILITY_H
+#define AVAILABILITY_H
+
+struct park;
+
+typedef struct availabilityBucket {
+    int availableSpots; // available spots of every park in the bucket
+    struct park* first; // parks of the bucket, by order of arrival
+    struct park* last;
+    struct availabilityBucket* higher; // bucket with more spots, or NULL
+    struct availabilityBucket* lower; // bucket with less spots, or NULL
+} AvailabilityBucket;
+
+typedef struct availabilityIndex {
+    AvailabilityBucket* highest; // bucket with the most spots, or NULL
+    AvailabilityBucket* spare; // emptied buckets, reused (linked by lower)
+} AvailabilityIndex;
+
+
+// Initializer
+void initAvailabilityIndex(AvailabilityIndex* index);
+
+// Free
+void freeAvailabilityIndex(AvailabilityIndex* index);
+
+// Insertion, update and removal of parks
+void indexPark(AvailabilityIndex* index, struct park* park);
+void updateAvailability(AvailabilityIndex* index, struct park* park,
+                        int availableSpots);
+void unindexPark(AvailabilityIndex* index, struct park* park);
+
+// Queries
+struct park* mostAvailablePark(const AvailabilityIndex* index);
+int printParksWithSpots(const AvailabilityIndex* index, int minimum);
+#endif
@@ -0,0 +1,448 @@
+#!/usr/bin/env python3
+"""
+Benchmark runner for the public tests.
+
+Builds the project (as in the README), extracts public-tests.zip and runs
+every test several times, checking the output byte for byte against the
+expected one. For each test it records the wall, user and sys times
+(medians of the runs) and the max RSS, and compares them against a stored
+baseline, flagging the ones that got slower or bigger than a threshold.
+
+The baseline is bench-baseline.txt, next to this script (another one can
+be given with -b). It is written by ./bench.py -s, from the measures of
+that run, once every output is right. Times depend on the machine, so the
+committed baseline only holds on the machine it was measured on (gcc -O3,
+one worker, five runs): on any other, save a new one with -s before
+comparing, and save it again after a change meant to alter performance.
+
+The max RSS is measured by a small wrapper that forks the project itself.
+A child forked by Python keeps Python's RSS as its peak across the exec,
+hiding anything under about 15 MB.
+
+With -a, every test is also run once by a build counting allocations
+(-DCOUNT_ALLOCATIONS), and the allocations per command of each command
+letter are checked against ALLOCATION_LIMITS: entries and exits must stay
+allocation-free apart from growing their structures, 'q' must not allocate
+at all, and the other commands must not allocate more than they do now.
+The public tests don't use every command, so a generated script using
+them all (see allocation_workload) is checked too.
+
+With -i, every test is also fed through the event file options, -r and
+-m, from a file and from a pipe, both as it is and compressed by -z, and
+each output is checked against the expected one.
+
+Usage:
+    ./bench.py [-n runs] [-t threshold] [-b baseline] [-s] [-e exe] [-a]
+               [-i] [-k tests]
+
+The exit status is 1 if an output is wrong or a test regressed.
+
+Author: Adolfo Monteiro
+"""
+import argparse
+import glob
+import itertools
+import os
+import shlex
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+import zipfile
+
+# Directory of the sources, public-tests.zip and the baseline
+ROOT = os.path.dirname(os.path.abspath(__file__))
+# Compilation command, from the README
+COMPILE = ["gcc", "-O3", "-Wall", "-Wextra", "-Werror",
+           "-Wno-unused-result", "-pthread", "-o"]
+# Wrapper running a command and writing its max RSS (in KB) to a file
+RSS_WRAPPER = r"""
+#include <stdio.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[]){
+    struct rusage usage;
+    int status;
+
+    if (argc < 3){
+        return 2;
+    }
+    pid_t pid = fork();
+    if (pid == 0){
+        execv(argv[2], argv + 2);
+        _exit(127);
+    }
+    if (pid < 0 || wait4(pid, &status, 0, &usage) < 0){
+        return 2;
+    }
+    FILE* file = fopen(argv[1], "w");
+    if (file == NULL){
+        return 2;
+    }
+    fprintf(file, "%ld\n", usage.ru_maxrss);
+    fclose(file);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
+"""
+# Columns of the baseline file, after the test name
+FIELDS = ["wall", "user", "sys", "rss"]
+# Increase in seconds always allowed, as short times are mostly noise
+NOISE_SECONDS = 0.02
+# Options reading an event file instead of stdin (checked with -i)
+EVENT_OPTIONS = ["-r", "-m"]
+# Most allocations per command of each command letter (checked with -a),
+# and the commands of the letter a run needs for the limit to apply. The
+# limits are the most measured in the public tests and allocation_workload,
+# plus a small margin. Entries and exits only allocate to grow their
+# structures (a new plate, day, log slab or a resize), so they're only
+# checked once that's amortized (test18 measures 0.034 per entry and 0.0013
+# per exit); every entry/exit allocating again means a hot path regressed.
+# The other commands allocate for their answers and temporary sets, about
+# the same every time
+ALLOCATION_LIMITS = {
+    "e": (0.04, 50000), "s": (0.002, 50000), "q": (0, 1),
+    "v": (6, 1), "f": (3.2, 1), "p": (13, 1), "r": (4.2, 1),
+    "i": (7.5, 1), "d": (9.5, 1), "a": (0.1, 1), "g": (3, 1),
+    "c": (0.1, 1), "u": (2, 1), "w": (4, 1), "n": (0.1, 1),
+    "x": (3, 1), "o": (14, 1)}
+# Rounds of allocation_workload, each using every command once or twice
+ALLOCATION_WORKLOAD_ROUNDS = 200
+
+
+def build(directory, name="proj1", flags=()):
+    """
+    @brief Compiles the project into a directory.
+
+    @param directory Where to write the executable.
+    @param name Name of the executable.
+    @param flags Extra compilation flags.
+    @return The path of the executable.
+    """
+    exe = os.path.join(directory, name)
+    sources = sorted(glob.glob(os.path.join(ROOT, "*.c")))
+    command = COMPILE[:1] + list(flags) + COMPILE[1:]
+    subprocess.run(command + [exe] + sources, check=True)
+    return exe
+
+
+def build_wrapper(directory):
+    """
+    @brief Compiles the RSS wrapper into a directory.
+
+    @param directory Where to write the wrapper.
+    @return The path of the wrapper.
+    """
+    source = os.path.join(directory, "rss.c")
+    wrapper = os.path.join(directory, "rss")
+    with open(source, "w") as file:
+        file.write(RSS_WRAPPER)
+    subprocess.run(["gcc", "-O2", "-o", wrapper, source], check=True)
+    return wrapper
+
+
+def extract_tests(directory):
+    """
+    @brief Extracts the public tests into a directory.
+
+    @param directory Where to extract public-tests.zip.
+    @return The sorted paths of the tests' inputs.
+    """
+    with zipfile.ZipFile(os.path.join(ROOT, "public-tests.zip")) as archive:
+        archive.extractall(directory)
+    return sorted(glob.glob(os.path.join(directory, "*", "test*.in")))
+
+
+def run_once(wrapper, exe, path):
+    """
+    @brief Runs the project once with a test's input.
+
+    @param wrapper Path of the RSS wrapper.
+    @param exe Path of the executable.
+    @param path Path of the test's input.
+    @return The output, and a dict with the wall, user and sys times (in
+    seconds) and the max RSS (in KB) of the run.
+    """
+    rss_path = os.path.join(os.path.dirname(wrapper), "rss.txt")
+    with open(path, "rb") as stdin:
+        start = time.perf_counter()
+        process = subprocess.Popen([wrapper, rss_path, exe], stdin=stdin,
+                                   stdout=subprocess.PIPE)
+        output = process.stdout.read()
+        process.stdout.close()
+        _, _, usage = os.wait4(process.pid, 0)
+        wall = time.perf_counter() - start
+    # wait4 already reaped it; keep Popen from waiting again
+    process.returncode = 0
+    # The times of the wrapper include the project's, as it waited for it
+    with open(rss_path) as file:
+        rss = int(file.read())
+    return output, {"wall": wall, "user": usage.ru_utime,
+                    "sys": usage.ru_stime, "rss": rss}
+
+
+def run_test(wrapper, exe, path, runs):
+    """
+    @brief Runs a test several times, checking its output.
+
+    @param wrapper Path of the RSS wrapper.
+    @param exe Path of the executable.
+    @param path Path of the test's input.
+    @param runs Number of runs.
+    @return 1 if every output matched, 0 otherwise, and the medians of the
+    times and the max RSS of the runs.
+    """
+    with open(path[:-len(".in")] + ".out", "rb") as expected_file:
+        expected = expected_file.read()
+
+    correct = 1
+    samples = []
+    for _ in range(runs):
+        output, sample = run_once(wrapper, exe, path)
+        correct &= output == expected
+        samples.append(sample)
+
+    result = {field: statistics.median(s[field] for s in samples)
+              for field in ("wall", "user", "sys")}
+    result["rss"] = max(s["rss"] for s in samples)
+    return correct, result
+
+
+def check_inputs(exe, path, directory):
+    """
+    @brief Feeds a test through the event file options, checking its output.
+
+    The test's input is given to each of EVENT_OPTIONS as it is and as
+    logged by -z (compressed), once as a file and once as a pipe (bash
+    process substitution), where nothing can be read twice.
+
+    @param exe Path of the executable.
+    @param path Path of the test's input.
+    @param directory Where to write the compressed input.
+    @return The ways of feeding the test that gave a wrong output.
+    """
+    with open(path[:-len(".in")] + ".out", "rb") as expected_file:
+        expected = expected_file.read()
+    compressed = os.path.join(directory, "input.lz")
+    with open(path, "rb") as stdin:
+        subprocess.run([exe, "-z", compressed], stdin=stdin,
+                       stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+    wrong = []
+    for option, (kind, source), pipe in itertools.product(
+            EVENT_OPTIONS, [("plain", path), ("compressed", compressed)],
+            [False, True]):
+        argument = shlex.quote(source)
+        if pipe:
+            argument = "<(cat %s)" % argument
+        command = "%s %s %s" % (shlex.quote(exe), option, argument)
+        output = subprocess.run(["bash", "-c", command],
+                                stdout=subprocess.PIPE,
+                                stderr=subprocess.DEVNULL).stdout
+        if output != expected:
+            wrong.append("%s(%s %s)" % (option, kind,
+                                        "pipe" if pipe else "file"))
+    return wrong
+
+
+def check_allocations(exe, path):
+    """
+    @brief Runs a test once counting allocations, checking them per command.
+
+    @param exe Path of an executable built with -DCOUNT_ALLOCATIONS, which
+    writes a table of the allocations by command letter to stderr.
+    @param path Path of the test's input.
+    @return The command letters over their ALLOCATION_LIMITS, each one with
+    its allocations per command.
+    """
+    with open(path, "rb") as stdin:
+        table = subprocess.run([exe], stdin=stdin, stdout=subprocess.DEVNULL,
+                               stderr=subprocess.PIPE).stderr.decode()
+
+    over = []
+    for line in table.splitlines():
+        # command commands allocating allocations max
+        parts = line.split()
+        if len(parts) != 5 or parts[0] not in ALLOCATION_LIMITS or \
+                not parts[1].isdigit():
+            continue
+        commands, allocations = int(parts[1]), int(parts[3])
+        limit, min_commands = ALLOCATION_LIMITS[parts[0]]
+        if commands < min_commands:
+            continue
+        if allocations > limit * commands:
+            over.append("%s(%.2f/command)" % (parts[0],
+                                               allocations / commands))
+    return over
+
+
+def allocation_workload(path):
+    """
+    @brief Writes a script using every command, for the allocation check.
+
+    Each round enters a new vehicle in one of three parks, watches it and
+    its park, gives it a pass, queries it, the parks and their groups, lets
+    it out and corrects its exit, and removes and recreates a fourth park.
+
+    @param path Path of the script to write.
+    """
+    lines = ["p W%d 500 0.25 0.40 20.00" % k for k in range(3)]
+    lines.append("p W3 500 0.25 0.40 20.00 "
+                 "rate sat-sun 00:00-24:00 0.10 0.10")
+    minute = 0
+    for i in range(ALLOCATION_WORKLOAD_ROUNDS):
+        day, rest = divmod(minute, 24 * 60)
+        date = "%02d-%02d-2024" % (day % 28 + 1, day // 28 + 1)
+        stamp = "%s %02d:%02d" % (date, rest // 60, rest % 60)
+        plate = "%02d-AA-%02d" % (i % 100, i // 100)
+        park = "W%d" % (i % 3)
+        lines += ["e %s %s %s" % (park, plate, stamp),
+                  "w %s" % plate, "w %s 2" % park, "n %d" % (2 * i + 1),
+                  "x %s %s %s" % (plate, date, date), "v %s" % plate,
+                  "f %s" % park, "f %s %s" % (park, date),
+                  "i W0 W1", "d W0 W1", "a", "a 1",
+                  "g G%d %s" % (i % 5, park), "g", "u", "u %s" % park,
+                  "u %s %s" % (park, date), "o", "p",
+                  "s %s %s %s" % (park, plate, stamp),
+                  "c %s %s %s %s" % (park, plate, stamp, stamp),
+                  "r W3", "p W3 500 0.25 0.40 20.00"]
+        minute += 7
+    lines.append("q")
+    with open(path, "w") as file:
+        file.write("\n".join(lines) + "\n")
+
+
+def read_baseline(path):
+    """
+    @brief Reads a baseline file (one test per line: name and FIELDS).
+
+    @param path Path of the baseline file.
+    @return A dict from test name to its measures (empty if no file).
+    """
+    baseline = {}
+    if not os.path.exists(path):
+        return baseline
+    with open(path) as file:
+        for line in file:
+            parts = line.split()
+            if len(parts) == len(FIELDS) + 1 and not line.startswith("#"):
+                baseline[parts[0]] = dict(zip(FIELDS, map(float, parts[1:])))
+    return baseline
+
+
+def write_baseline(path, results):
+    """
+    @brief Writes the measures of the tests as the new baseline.
+
+    @param path Path of the baseline file.
+    @param results A dict from test name to its measures.
+    """
+    with open(path, "w") as file:
+        file.write("# test " + " ".join(FIELDS) + "\n")
+        for name, result in sorted(results.items()):
+            file.write("%s %.6f %.6f %.6f %d\n" % (name, result["wall"],
+                       result["user"], result["sys"], result["rss"]))
+
+
+def regressions(result, base, threshold):
+    """
+    @brief Lists the measures of a test worse than its baseline.
+
+    @param result The measures of the test.
+    @param base The baseline measures of the test, or None.
+    @param threshold Relative increase allowed (0.1 is 10%).
+    @return The names of the measures that regressed.
+    """
+    if base is None:
+        return []
+    worse = []
+    for field in FIELDS:
+        limit = base[field] * (1 + threshold)
+        if field != "rss":
+            limit = max(limit, base[field] + NOISE_SECONDS)
+        if result[field] > limit:
+            worse.append(field)
+    return worse
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark the public "
+                                     "tests against a baseline.")
+    parser.add_argument("-n", "--runs", type=int, default=5,
+                        help="runs of each test (default 5)")
+    parser.add_argument("-t", "--threshold", type=float, default=0.10,
+                        help="relative increase flagged (default 0.10)")
+    parser.add_argument("-b", "--baseline",
+                        default=os.path.join(ROOT, "bench-baseline.txt"),
+                        help="baseline file (default bench-baseline.txt)")
+    parser.add_argument("-s", "--save", action="store_true",
+                        help="save the measures as the new baseline")
+    parser.add_argument("-e", "--exe",
+                        help="executable to run, instead of building one")
+    parser.add_argument("-a", "--allocations", action="store_true",
+                        help="also check the allocations per command")
+    parser.add_argument("-i", "--inputs", action="store_true",
+                        help="also check the tests fed through -r and -m")
+    parser.add_argument("-k", "--tests", nargs="*", default=[],
+                        help="only run these tests (e.g. test17)")
+    args = parser.parse_args()
+    if args.runs < 1:
+        parser.error("runs must be at least 1")
+
+    baseline = read_baseline(args.baseline)
+    results = {}
+    failed = 0
+    with tempfile.TemporaryDirectory() as directory:
+        exe = os.path.abspath(args.exe) if args.exe else build(directory)
+        wrapper = build_wrapper(directory)
+        if args.allocations:
+            counting = build(directory, "proj1-allocs",
+                             ["-DCOUNT_ALLOCATIONS"])
+        print("%-8s %9s %9s %9s %9s  %s" % ("test", "wall", "user", "sys",
+              "rss(KB)", "result"))
+        for path in extract_tests(directory):
+            name = os.path.basename(path)[:-len(".in")]
+            if args.tests and name not in args.tests:
+                continue
+            correct, result = run_test(wrapper, exe, path, args.runs)
+            results[name] = result
+            worse = regressions(result, baseline.get(name), args.threshold)
+            if args.inputs:
+                wrong = check_inputs(exe, path, directory)
+                correct &= not wrong
+            over = check_allocations(counting, path) \
+                if args.allocations else []
+            status = "ok" if correct else "WRONG OUTPUT"
+            if args.inputs and wrong:
+                status += " through " + " ".join(wrong)
+            if worse:
+                status += ", slower/bigger: " + " ".join(worse)
+            if over:
+                status += ", allocating: " + " ".join(over)
+            failed += not correct or bool(worse) or bool(over)
+            print("%-8s %9.4f %9.4f %9.4f %9d  %s" % (name, result["wall"],
+                  result["user"], result["sys"], result["rss"], status))
+        if args.allocations:
+            workload = os.path.join(directory, "workload.in")
+            allocation_workload(workload)
+            over = check_allocations(counting, workload)
+            failed += bool(over)
+            print("%-8s %39s  %s" % ("commands", "",
+                  "allocating: " + " ".join(over) if over else "ok"))
+
+    if args.save:
+        # Tests not run (see -k) keep their old baseline
+        baseline.update(results)
+        write_baseline(args.baseline, baseline)
+    elif not baseline:
+        print("no baseline at %s (use -s to save one)" % args.baseline)
+    # The workload of the allocation check counts as a test
+    total = len(results) + (1 if args.allocations else 0)
+    print("%d of %d tests failed" % (failed, total))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
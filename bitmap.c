@@ -0,0 +1,660 @@
+/**
+ * Implementation of the functions related to compressed bitmaps.
+ *
+ * Bitmaps store sets of 32-bit integers split in containers of 2^16 values.
+ * Sparse containers are sorted arrays, dense ones are bitsets.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "bitmap.h"
+
+// Number of bits of the low part of each value (kept in the containers)
+#define BITMAP_LOW_BITS 16
+// Mask selecting the low part of each value
+#define BITMAP_LOW_MASK 0xFFFFu
+// Initial length of the containers array and of each array container
+#define BITMAP_INITIAL_CAPACITY 4
+
+
+/**
+ * @brief Creates a new, empty, bitmap.
+ *
+ * @return Pointer to the newly created bitmap.
+ */
+Bitmap* newBitmap(){
+    Bitmap* bitmap = (Bitmap*)malloc(sizeof(Bitmap));
+
+    bitmap->containers = NULL;
+    bitmap->numContainers = 0;
+    bitmap->capacity = 0;
+
+    return bitmap;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a container's values.
+ *
+ * @param c Pointer to the container.
+ */
+void freeContainer(Container* c){
+    free(c->values);
+    free(c->words);
+}
+
+
+/**
+ * @brief Frees the memory allocated for a bitmap and all its containers.
+ *
+ * @param bitmap Pointer to the bitmap.
+ */
+void freeBitmap(Bitmap* bitmap){
+    for (unsigned int i = 0; i < bitmap->numContainers; i++){
+        freeContainer(&bitmap->containers[i]);
+    }
+    free(bitmap->containers);
+    free(bitmap);
+}
+
+
+/**
+ * @brief Finds the position of the container with the given key.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param key High 16 bits of the values of the container.
+ * @param found Set to 1 if the container exists, 0 otherwise.
+ * @return Position of the container, or where it should be inserted.
+ */
+unsigned int findContainer(const Bitmap* bitmap, unsigned short key,
+int* found){
+    unsigned int low = 0, high = bitmap->numContainers;
+
+    // Binary search on the container keys
+    while (low < high){
+        unsigned int middle = (low + high) / 2;
+        if (bitmap->containers[middle].key < key)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    *found = low < bitmap->numContainers &&
+            bitmap->containers[low].key == key;
+    return low;
+}
+
+
+/**
+ * @brief Inserts an empty array container in the given position.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param position Where to insert the container (keeps keys sorted).
+ * @param key High 16 bits of the values of the container.
+ * @return Pointer to the new container.
+ */
+Container* insertContainer(Bitmap* bitmap, unsigned int position,
+unsigned short key){
+    if (bitmap->numContainers == bitmap->capacity){
+        bitmap->capacity = bitmap->capacity ?
+                            bitmap->capacity * 2 : BITMAP_INITIAL_CAPACITY;
+        bitmap->containers = (Container*)realloc(bitmap->containers,
+                                bitmap->capacity * sizeof(Container));
+    }
+
+    memmove(&bitmap->containers[position + 1], &bitmap->containers[position],
+            (bitmap->numContainers - position) * sizeof(Container));
+    bitmap->numContainers++;
+
+    Container* c = &bitmap->containers[position];
+    c->key = key;
+    c->cardinality = 0;
+    c->values = NULL;
+    c->valuesCapacity = 0;
+    c->words = NULL;
+    return c;
+}
+
+
+/**
+ * @brief Finds the position of a low value in an array container.
+ *
+ * @param c Pointer to the array container.
+ * @param low Low 16 bits of the value.
+ * @param found Set to 1 if the value exists, 0 otherwise.
+ * @return Position of the value, or where it should be inserted.
+ */
+unsigned int findArrayValue(const Container* c, unsigned short low,
+int* found){
+    unsigned int first = 0, last = c->cardinality;
+
+    while (first < last){
+        unsigned int middle = (first + last) / 2;
+        if (c->values[middle] < low)
+            first = middle + 1;
+        else
+            last = middle;
+    }
+
+    *found = first < c->cardinality && c->values[first] == low;
+    return first;
+}
+
+
+/**
+ * @brief Writes the values of a container as a bitset.
+ *
+ * @param c Pointer to the container.
+ * @param words Where to write the BITMAP_WORDS words of the bitset.
+ */
+void containerToWords(const Container* c, unsigned long long* words){
+    if (c->words != NULL){
+        memcpy(words, c->words, BITMAP_WORDS * sizeof(unsigned long long));
+        return;
+    }
+
+    memset(words, 0, BITMAP_WORDS * sizeof(unsigned long long));
+    for (unsigned int i = 0; i < c->cardinality; i++){
+        words[c->values[i] / BITMAP_WORD_BITS] |=
+            1ULL << (c->values[i] % BITMAP_WORD_BITS);
+    }
+}
+
+
+/**
+ * @brief Writes the values of a bitset as a sorted array.
+ *
+ * @param words The BITMAP_WORDS words of the bitset.
+ * @param values Where to write the values.
+ * @return The number of values written.
+ */
+unsigned int wordsToArray(const unsigned long long* words,
+unsigned short* values){
+    unsigned int count = 0;
+
+    for (unsigned int i = 0; i < BITMAP_WORDS; i++){
+        unsigned long long word = words[i];
+        // Extract the set bits from the lowest to the highest
+        while (word != 0){
+            values[count++] = (unsigned short)(i * BITMAP_WORD_BITS +
+                                                __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Counts the values in a bitset.
+ *
+ * @param words The BITMAP_WORDS words of the bitset.
+ * @return The number of set bits.
+ */
+unsigned int wordsCardinality(const unsigned long long* words){
+    unsigned int count = 0;
+
+    for (unsigned int i = 0; i < BITMAP_WORDS; i++){
+        count += __builtin_popcountll(words[i]);
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Fills an empty container with the given values, choosing the
+ * array or the bitset representation according to how many there are.
+ *
+ * @param c Pointer to the (empty) container.
+ * @param words The values, as a bitset of BITMAP_WORDS words.
+ * @param cardinality The number of values in the bitset.
+ */
+void fillContainer(Container* c, const unsigned long long* words,
+unsigned int cardinality){
+    c->cardinality = cardinality;
+
+    if (cardinality > BITMAP_ARRAY_MAX){
+        c->words = (unsigned long long*)malloc(
+                    BITMAP_WORDS * sizeof(unsigned long long));
+        memcpy(c->words, words, BITMAP_WORDS * sizeof(unsigned long long));
+        return;
+    }
+
+    c->valuesCapacity = cardinality;
+    c->values = (unsigned short*)malloc(
+                (cardinality ? cardinality : 1) * sizeof(unsigned short));
+    wordsToArray(words, c->values);
+}
+
+
+/**
+ * @brief Adds a low value to a container, converting it to a bitset if the
+ * array representation becomes too big.
+ *
+ * @param c Pointer to the container.
+ * @param low Low 16 bits of the value.
+ */
+void containerAdd(Container* c, unsigned short low){
+    unsigned long long bit = 1ULL << (low % BITMAP_WORD_BITS);
+
+    if (c->words != NULL){
+        if (!(c->words[low / BITMAP_WORD_BITS] & bit)){
+            c->words[low / BITMAP_WORD_BITS] |= bit;
+            c->cardinality++;
+        }
+        return;
+    }
+
+    int found;
+    unsigned int position = findArrayValue(c, low, &found);
+    if (found)
+        return;
+
+    if (c->cardinality == BITMAP_ARRAY_MAX){
+        // The array is full: switch to the bitset representation
+        unsigned long long words[BITMAP_WORDS];
+        containerToWords(c, words);
+        words[low / BITMAP_WORD_BITS] |= bit;
+        free(c->values);
+        c->values = NULL;
+        c->valuesCapacity = 0;
+        fillContainer(c, words, c->cardinality + 1);
+        return;
+    }
+
+    if (c->cardinality == c->valuesCapacity){
+        c->valuesCapacity = c->valuesCapacity ?
+                            c->valuesCapacity * 2 : BITMAP_INITIAL_CAPACITY;
+        c->values = (unsigned short*)realloc(c->values,
+                    c->valuesCapacity * sizeof(unsigned short));
+    }
+    memmove(&c->values[position + 1], &c->values[position],
+            (c->cardinality - position) * sizeof(unsigned short));
+    c->values[position] = low;
+    c->cardinality++;
+}
+
+
+/**
+ * @brief Removes a low value from a container, converting it back to an
+ * array if the bitset becomes sparse enough.
+ *
+ * The bitset only becomes an array again at half the array limit, so
+ * values entering and leaving around the limit don't convert the container
+ * (and allocate) every time.
+ *
+ * @param c Pointer to the container.
+ * @param low Low 16 bits of the value.
+ */
+void containerRemove(Container* c, unsigned short low){
+    unsigned long long bit = 1ULL << (low % BITMAP_WORD_BITS);
+
+    if (c->words != NULL){
+        if (!(c->words[low / BITMAP_WORD_BITS] & bit))
+            return;
+        c->words[low / BITMAP_WORD_BITS] &= ~bit;
+        c->cardinality--;
+        if (c->cardinality <= BITMAP_ARRAY_MAX / 2){
+            unsigned long long* words = c->words;
+            c->words = NULL;
+            fillContainer(c, words, c->cardinality);
+            free(words);
+        }
+        return;
+    }
+
+    int found;
+    unsigned int position = findArrayValue(c, low, &found);
+    if (!found)
+        return;
+
+    c->cardinality--;
+    memmove(&c->values[position], &c->values[position + 1],
+            (c->cardinality - position) * sizeof(unsigned short));
+}
+
+
+/**
+ * @brief Adds a value to a bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value to add.
+ */
+void bitmapAdd(Bitmap* bitmap, unsigned int value){
+    unsigned short key = (unsigned short)(value >> BITMAP_LOW_BITS);
+    int found;
+    unsigned int position = findContainer(bitmap, key, &found);
+
+    Container* c = found ? &bitmap->containers[position] :
+                            insertContainer(bitmap, position, key);
+    containerAdd(c, (unsigned short)(value & BITMAP_LOW_MASK));
+}
+
+
+/**
+ * @brief Removes a value from a bitmap.
+ *
+ * A container left empty is kept, with its memory, so adding values to it
+ * again doesn't allocate.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value to remove.
+ */
+void bitmapRemove(Bitmap* bitmap, unsigned int value){
+    int found;
+    unsigned int position = findContainer(bitmap,
+                            (unsigned short)(value >> BITMAP_LOW_BITS), &found);
+    if (!found)
+        return;
+
+    containerRemove(&bitmap->containers[position],
+                    (unsigned short)(value & BITMAP_LOW_MASK));
+}
+
+
+/**
+ * @brief Checks if a value is in a bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param value The value to look for.
+ * @return 1 if the value is in the bitmap, 0 otherwise.
+ */
+int bitmapContains(const Bitmap* bitmap, unsigned int value){
+    int found;
+    unsigned int position = findContainer(bitmap,
+                            (unsigned short)(value >> BITMAP_LOW_BITS), &found);
+    if (!found)
+        return 0;
+
+    const Container* c = &bitmap->containers[position];
+    unsigned short low = (unsigned short)(value & BITMAP_LOW_MASK);
+    if (c->words != NULL){
+        return (c->words[low / BITMAP_WORD_BITS] >>
+                (low % BITMAP_WORD_BITS)) & 1;
+    }
+    findArrayValue(c, low, &found);
+    return found;
+}
+
+
+/**
+ * @brief Counts the values in a bitmap.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @return The number of values in the bitmap.
+ */
+unsigned int bitmapCardinality(const Bitmap* bitmap){
+    unsigned int count = 0;
+
+    for (unsigned int i = 0; i < bitmap->numContainers; i++){
+        count += bitmap->containers[i].cardinality;
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Writes all the values of a bitmap in ascending order.
+ *
+ * @param bitmap Pointer to the bitmap.
+ * @param values Where to write the values (bitmapCardinality long).
+ * @return The number of values written.
+ */
+unsigned int bitmapToArray(const Bitmap* bitmap, unsigned int* values){
+    unsigned int count = 0;
+
+    for (unsigned int i = 0; i < bitmap->numContainers; i++){
+        const Container* c = &bitmap->containers[i];
+        unsigned int high = (unsigned int)c->key << BITMAP_LOW_BITS;
+
+        if (c->words == NULL){
+            for (unsigned int j = 0; j < c->cardinality; j++){
+                values[count++] = high | c->values[j];
+            }
+            continue;
+        }
+        for (unsigned int j = 0; j < BITMAP_WORDS; j++){
+            unsigned long long word = c->words[j];
+            while (word != 0){
+                values[count++] = high | (j * BITMAP_WORD_BITS +
+                                            __builtin_ctzll(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+    return count;
+}
+
+
+/**
+ * @brief Appends a container, built from a bitset, to the end of a bitmap.
+ *
+ * Empty results are not appended.
+ *
+ * @param bitmap Pointer to the bitmap (keys must stay sorted).
+ * @param key High 16 bits of the values of the container.
+ * @param words The values, as a bitset of BITMAP_WORDS words.
+ */
+void appendWords(Bitmap* bitmap, unsigned short key,
+const unsigned long long* words){
+    unsigned int cardinality = wordsCardinality(words);
+
+    if (cardinality > 0){
+        fillContainer(insertContainer(bitmap, bitmap->numContainers, key),
+                        words, cardinality);
+    }
+}
+
+
+/**
+ * @brief Appends an array container to the end of a bitmap.
+ *
+ * Empty results are not appended.
+ *
+ * @param bitmap Pointer to the bitmap (keys must stay sorted).
+ * @param key High 16 bits of the values of the container.
+ * @param values Sorted low values (at most BITMAP_ARRAY_MAX).
+ * @param n Number of values.
+ */
+void appendArray(Bitmap* bitmap, unsigned short key,
+const unsigned short* values, unsigned int n){
+    if (n == 0)
+        return;
+
+    Container* c = insertContainer(bitmap, bitmap->numContainers, key);
+    c->cardinality = n;
+    c->valuesCapacity = n;
+    c->values = (unsigned short*)malloc(n * sizeof(unsigned short));
+    memcpy(c->values, values, n * sizeof(unsigned short));
+}
+
+
+/**
+ * @brief Appends a copy of a container to the end of a bitmap.
+ *
+ * @param bitmap Pointer to the bitmap (keys must stay sorted).
+ * @param c Pointer to the container to copy.
+ */
+void appendCopy(Bitmap* bitmap, const Container* c){
+    if (c->words != NULL)
+        appendWords(bitmap, c->key, c->words);
+    else
+        appendArray(bitmap, c->key, c->values, c->cardinality);
+}
+
+
+/**
+ * @brief Combines two sorted arrays of low values.
+ *
+ * @param a Pointer to the first array container.
+ * @param b Pointer to the second array container.
+ * @param op '&' for intersection, '-' for difference, '|' for union.
+ * @param out Where to write the sorted result.
+ * @return The number of values written.
+ */
+unsigned int combineArrays(const Container* a, const Container* b, char op,
+unsigned short* out){
+    unsigned int i = 0, j = 0, count = 0;
+
+    while (i < a->cardinality && j < b->cardinality){
+        if (a->values[i] == b->values[j]){
+            if (op != '-')
+                out[count++] = a->values[i];
+            i++;
+            j++;
+        }
+        else if (a->values[i] < b->values[j]){
+            if (op != '&')
+                out[count++] = a->values[i];
+            i++;
+        }
+        else{
+            if (op == '|')
+                out[count++] = b->values[j];
+            j++;
+        }
+    }
+    // Leftovers only belong to the difference (from a) or the union
+    while (op != '&' && i < a->cardinality)
+        out[count++] = a->values[i++];
+    while (op == '|' && j < b->cardinality)
+        out[count++] = b->values[j++];
+
+    return count;
+}
+
+
+/**
+ * @brief Combines two bitsets, a whole word at a time.
+ *
+ * The loops have no dependencies between words so the compiler vectorizes
+ * them.
+ *
+ * @param x The first bitset (overwritten with the result).
+ * @param y The second bitset.
+ * @param op '&' for intersection, '-' for difference, '|' for union.
+ */
+void combineWords(unsigned long long* x, const unsigned long long* y,
+char op){
+    if (op == '&'){
+        for (unsigned int i = 0; i < BITMAP_WORDS; i++)
+            x[i] &= y[i];
+    }
+    else if (op == '-'){
+        for (unsigned int i = 0; i < BITMAP_WORDS; i++)
+            x[i] &= ~y[i];
+    }
+    else{
+        for (unsigned int i = 0; i < BITMAP_WORDS; i++)
+            x[i] |= y[i];
+    }
+}
+
+
+/**
+ * @brief Combines two containers with the same key, appending the result to
+ * a bitmap.
+ *
+ * @param result Pointer to the bitmap where the result is appended.
+ * @param a Pointer to the container of the first bitmap.
+ * @param b Pointer to the container of the second bitmap.
+ * @param op '&' for intersection, '-' for difference, '|' for union.
+ */
+void combineContainers(Bitmap* result, const Container* a,
+const Container* b, char op){
+    // Two small arrays are merged without building bitsets
+    if (a->words == NULL && b->words == NULL &&
+        (op != '|' || a->cardinality + b->cardinality <= BITMAP_ARRAY_MAX)){
+        unsigned short values[BITMAP_ARRAY_MAX];
+        appendArray(result, a->key, values, combineArrays(a, b, op, values));
+        return;
+    }
+
+    unsigned long long x[BITMAP_WORDS], y[BITMAP_WORDS];
+    containerToWords(a, x);
+    containerToWords(b, y);
+    combineWords(x, y, op);
+    appendWords(result, a->key, x);
+}
+
+
+/**
+ * @brief Combines two bitmaps into a new one.
+ *
+ * @param a Pointer to the first bitmap.
+ * @param b Pointer to the second bitmap.
+ * @param op '&' for intersection, '-' for difference, '|' for union.
+ * @return Pointer to the new bitmap with the result.
+ */
+Bitmap* combineBitmaps(const Bitmap* a, const Bitmap* b, char op){
+    Bitmap* result = newBitmap();
+    unsigned int i = 0, j = 0;
+
+    // Walk both container lists by ascending key
+    while (i < a->numContainers || j < b->numContainers){
+        const Container* ca = i < a->numContainers ? &a->containers[i] : NULL;
+        const Container* cb = j < b->numContainers ? &b->containers[j] : NULL;
+
+        if (ca != NULL && cb != NULL && ca->key == cb->key){
+            combineContainers(result, ca, cb, op);
+            i++;
+            j++;
+        }
+        else if (cb == NULL || (ca != NULL && ca->key < cb->key)){
+            // Key only in a: kept by the difference and the union
+            if (op != '&')
+                appendCopy(result, ca);
+            i++;
+        }
+        else{
+            // Key only in b: kept by the union
+            if (op == '|')
+                appendCopy(result, cb);
+            j++;
+        }
+    }
+
+    return result;
+}
+
+
+/**
+ * @brief Computes the values present in both bitmaps.
+ *
+ * @param a Pointer to the first bitmap.
+ * @param b Pointer to the second bitmap.
+ * @return Pointer to a new bitmap with the intersection.
+ */
+Bitmap* bitmapAnd(const Bitmap* a, const Bitmap* b){
+    return combineBitmaps(a, b, '&');
+}
+
+
+/**
+ * @brief Computes the values present in the first bitmap but not in the
+ * second.
+ *
+ * @param a Pointer to the first bitmap.
+ * @param b Pointer to the second bitmap.
+ * @return Pointer to a new bitmap with the difference.
+ */
+Bitmap* bitmapAndNot(const Bitmap* a, const Bitmap* b){
+    return combineBitmaps(a, b, '-');
+}
+
+
+/**
+ * @brief Computes the values present in any of the bitmaps.
+ *
+ * @param a Pointer to the first bitmap.
+ * @param b Pointer to the second bitmap.
+ * @return Pointer to a new bitmap with the union.
+ */
+Bitmap* bitmapOr(const Bitmap* a, const Bitmap* b){
+    return combineBitmaps(a, b, '|');
+}
@@ -0,0 +1,56 @@
+/**
+ * Definition of the compressed bitmap struct, and of the function prototypes
+ * related to it.
+ *
+ * Bitmaps store sets of 32-bit integers (such as plate ids) split in
+ * containers of 2^16 values, in the style of roaring bitmaps. Sparse
+ * containers are kept as sorted arrays, dense ones as plain bitsets, so set
+ * operations work on whole 64-bit words at a time.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef BITMAP_H
+#define BITMAP_H
+
+// Maximum number of values in an array container
+#define BITMAP_ARRAY_MAX 4096
+// Number of 64-bit words of a bitset container (2^16 bits)
+#define BITMAP_WORDS 1024
+// Number of bits in each bitset word
+#define BITMAP_WORD_BITS 64
+
+typedef struct container {
+    unsigned short key; // high 16 bits shared by every value
+    unsigned int cardinality; // number of values in the container
+    unsigned short* values; // sorted low 16 bits, if it's an array container
+    unsigned int valuesCapacity; // allocated length of values
+    unsigned long long* words; // bitset of the low 16 bits, or NULL
+} Container;
+
+typedef struct bitmap {
+    Container* containers; // sorted by key
+    unsigned int numContainers;
+    unsigned int capacity; // allocated length of containers
+} Bitmap;
+
+
+// Initializer
+Bitmap* newBitmap();
+
+// Free
+void freeBitmap(Bitmap* bitmap);
+
+// Single value operations
+void bitmapAdd(Bitmap* bitmap, unsigned int value);
+void bitmapRemove(Bitmap* bitmap, unsigned int value);
+int bitmapContains(const Bitmap* bitmap, unsigned int value);
+
+// Getters
+unsigned int bitmapCardinality(const Bitmap* bitmap);
+unsigned int bitmapToArray(const Bitmap* bitmap, unsigned int* values);
+
+// Set operations (they return a new bitmap)
+Bitmap* bitmapAnd(const Bitmap* a, const Bitmap* b);
+Bitmap* bitmapAndNot(const Bitmap* a, const Bitmap* b);
+Bitmap* bitmapOr(const Bitmap* a, const Bitmap* b);
+#endif
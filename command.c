@@ -0,0 +1,86 @@
+/**
+ * Implementation of the functions that parse command lines.
+ *
+ * These parsers are shared by every path that processes commands: the
+ * interactive loop, the reorder buffer and the replay of event files.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "command.h"
+
+
+/**
+ * @brief Parses an entry ('e') or exit ('s') command.
+ * 
+ * @param entry_data The input command string.
+ * @param command Where to store the command character.
+ * @param parkName Where to store the park name.
+ * @param plate Where to store the license plate.
+ * @param timestamp Where to store the timestamp of the entry or exit.
+ * @param consumed Where to store how many characters were parsed.
+ * @return 1 if every field was parsed, 0 otherwise.
+ */
+int parseEntryExit(char entry_data[BUFSIZ], char* command,
+char parkName[PARK_NAME_LENGTH], char plate[PLATE_LENGTH],
+Timestamp* timestamp, int* consumed){
+    int day = 0, month = 0, year = 0, hour = 0, minute = 0;
+
+    // Use sscanf to parse the entry data, into fixed buffers so entries
+    // and exits don't allocate memory
+    // First try to match the park name if it is between quotes
+    *consumed = 0;
+    parkName[0] = '\0';
+    plate[0] = '\0';
+    int result = sscanf(entry_data,
+        "%c \"%" PARK_NAME_WIDTH "[^\"]\" %8s %d-%d-%d %d:%d%n",
+        command, parkName, plate, &day, &month, &year, &hour, &minute,
+        consumed);
+
+    if (result != 8){ // The park name is not between quotes
+        result = sscanf(entry_data,
+            "%c %" PARK_NAME_WIDTH "s %8s %d-%d-%d %d:%d%n",
+            command, parkName, plate, &day, &month, &year, &hour, &minute,
+            consumed);
+    }
+
+    *timestamp = newTimestamp(day, month, year, hour, minute);
+    return result == 8;
+}
+
+
+/**
+ * @brief Parses the optional event id at the end of an entry/exit command.
+ * 
+ * @param entry_data The input command string.
+ * @param consumed How many characters parseEntryExit parsed.
+ * @param eventId Where to store the event id.
+ * @return 1 if the command has an event id, 0 otherwise.
+ */
+int parseEventId(const char entry_data[BUFSIZ], int consumed,
+unsigned long long* eventId){
+    return consumed > 0 && sscanf(entry_data + consumed, "%llu", eventId) == 1;
+}
+
+
+/**
+ * @brief Parses the optional exit timestamp at the end of a correction
+ * command (which starts like an entry/exit command).
+ * 
+ * @param entry_data The input command string.
+ * @param consumed How many characters parseEntryExit parsed.
+ * @param exit Where to store the exit timestamp.
+ * @return 1 if the command has an exit timestamp, 0 otherwise.
+ */
+int parseCorrectedExit(const char entry_data[BUFSIZ], int consumed,
+Timestamp* exit){
+    int day, month, year, hour, minute;
+
+    if (consumed == 0 || sscanf(entry_data + consumed, "%d-%d-%d %d:%d",
+                                &day, &month, &year, &hour, &minute) != 5){
+        return 0;
+    }
+    *exit = newTimestamp(day, month, year, hour, minute);
+    return 1;
+}
@@ -0,0 +1,31 @@
+/**
+ * Function prototypes of the parsers of command lines.
+ *
+ * These parsers are shared by every path that processes commands: the
+ * interactive loop, the reorder buffer and the replay of event files.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef COMMAND_H
+#define COMMAND_H
+
+#include <stdio.h>
+#include "plate.h"
+#include "timestamp.h"
+
+// Length of the buffer of a park name (a whole line always fits)
+#define PARK_NAME_LENGTH 8192
+// Maximum number of characters of a park name, for scanf
+#define PARK_NAME_WIDTH "8191"
+
+// Entry/exit parsing
+int parseEntryExit(char entry_data[BUFSIZ], char* command,
+                    char parkName[PARK_NAME_LENGTH], char plate[PLATE_LENGTH],
+                    Timestamp* timestamp, int* consumed);
+int parseEventId(const char entry_data[BUFSIZ], int consumed,
+                    unsigned long long* eventId);
+
+// Correction parsing
+int parseCorrectedExit(const char entry_data[BUFSIZ], int consumed,
+                        Timestamp* exit);
+#endif
@@ -0,0 +1,149 @@
+/**
+ * Implementation of the functions related to the config.
+ *
+ * The config holds the options given to the program in the command line.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "config.h"
+
+// Usage message shown when the options are not valid
+#define USAGE "usage: %s [-w minutes] [-c exits] [-b] [-d] [-j workers] " \
+                "[-r file | -m file...] [-z file] [-t file] [-P] " \
+                "[-l microseconds]\n"
+
+
+/**
+ * @brief Reads the non-negative integer value of an option.
+ *
+ * @param argc Number of command line arguments.
+ * @param argv The command line arguments.
+ * @param i Pointer to the index of the option, advanced to its value.
+ * @param value Where to store the value.
+ * @return 1 if a valid value was read, 0 otherwise.
+ */
+int readOptionValue(int argc, char* argv[], int* i, int* value){
+    char* end;
+
+    if (*i + 1 >= argc){
+        return 0;
+    }
+    (*i)++;
+    long parsed = strtol(argv[*i], &end, 10);
+    if (*end != '\0' || end == argv[*i] || parsed < 0){
+        return 0;
+    }
+    *value = (int)parsed;
+    return 1;
+}
+
+
+/**
+ * @brief Parses the command line options into a config.
+ *
+ * Options:
+ * -w minutes: hold entries/exits up to that many minutes behind the newest
+ * one, releasing them in chronological order (reorder buffer).
+ * -c exits: print billing reports ('f') that many exits at a time, after
+ * each command, instead of all at once.
+ * -b: answer entries/exits, 'v' and 'f' with binary records (see output.h).
+ * -d: hash every answer instead of writing it, those binary records and
+ * the text of the other commands, and write only the digest at the end.
+ * -j workers: run batch jobs on that many workers (1 by default).
+ * -r file: replay the commands of an event file instead of reading stdin,
+ * processing runs of entries/exits in parallel (not with -w).
+ * -m file: merge the commands of several event files instead of reading
+ * stdin, each one in chronological order, by their timestamps (given once
+ * per file, up to MAX_FEEDS; not with -r).
+ * -z file: log the commands processed to the file, compressed (see lz.h),
+ * in the order they were processed, so -r replays them (not with -r).
+ * Files given to -r and -m may be compressed too.
+ * -t file: record spans of the commands and write them to the file, as
+ * Chrome trace-event JSON, at the end.
+ * -P: read the hardware counters around the spans of the main thread, and
+ * write their totals by span (command letter or phase) to stderr at the
+ * end.
+ * -l microseconds: write the commands taking at least that long to stderr,
+ * with their park, hashtable probe and output size (see slowlog.h).
+ *
+ * @param argc Number of command line arguments.
+ * @param argv The command line arguments.
+ * @param config Pointer to the config to fill.
+ * @return 1 if the options are valid, 0 otherwise (usage is printed).
+ */
+int parseConfig(int argc, char* argv[], Config* config){
+    config->reorderWatermark = OPTION_UNSET;
+    config->reportSlice = OPTION_UNSET;
+    config->binaryOutput = 0;
+    config->digestOutput = 0;
+    config->numWorkers = 1;
+    config->replayPath = NULL;
+    config->numFeeds = 0;
+    config->logPath = NULL;
+    config->tracePath = NULL;
+    config->spanStats = 0;
+    config->slowThreshold = OPTION_UNSET;
+
+    for (int i = 1; i < argc; i++){
+        int valid = 0;
+        if (strcmp(argv[i], "-w") == 0){
+            valid = readOptionValue(argc, argv, &i, &config->reorderWatermark);
+        }
+        else if (strcmp(argv[i], "-P") == 0){
+            valid = config->spanStats = 1;
+        }
+        else if (strcmp(argv[i], "-b") == 0){
+            valid = config->binaryOutput = 1;
+        }
+        else if (strcmp(argv[i], "-d") == 0){
+            valid = config->digestOutput = 1;
+        }
+        else if (strcmp(argv[i], "-j") == 0){
+            valid = readOptionValue(argc, argv, &i, &config->numWorkers) &&
+                    config->numWorkers > 0 &&
+                    config->numWorkers <= MAX_WORKERS;
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc){
+            config->replayPath = argv[++i];
+            valid = 1;
+        }
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc &&
+                    config->numFeeds < MAX_FEEDS){
+            config->feedPaths[config->numFeeds++] = argv[++i];
+            valid = 1;
+        }
+        else if (strcmp(argv[i], "-z") == 0 && i + 1 < argc){
+            config->logPath = argv[++i];
+            valid = 1;
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc){
+            config->tracePath = argv[++i];
+            valid = 1;
+        }
+        else if (strcmp(argv[i], "-l") == 0){
+            valid = readOptionValue(argc, argv, &i, &config->slowThreshold);
+        }
+        else if (strcmp(argv[i], "-c") == 0){
+            valid = readOptionValue(argc, argv, &i, &config->reportSlice) &&
+                    config->reportSlice > 0;
+        }
+        if (!valid){
+            fprintf(stderr, USAGE, argv[0]);
+            return 0;
+        }
+    }
+
+    // A replayed file is already in order and logged, and replaces the
+    // merged files
+    if (config->replayPath != NULL &&
+        (config->reorderWatermark != OPTION_UNSET || config->numFeeds > 0 ||
+        config->logPath != NULL)){
+        fprintf(stderr, USAGE, argv[0]);
+        return 0;
+    }
+
+    return 1;
+}
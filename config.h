@@ -0,0 +1,51 @@
+/**
+ * Definition of the config struct, and of the function prototypes related
+ * to it.
+ *
+ * The config holds the options given to the program in the command line.
+ * Without options the program behaves exactly as specified, reading
+ * commands from stdin and answering in stdout.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "merge.h"
+
+// Value of an option that was not given
+#define OPTION_UNSET -1
+// Maximum number of workers (-j)
+#define MAX_WORKERS 64
+
+typedef struct config {
+    // Minutes entries/exits may arrive out of order (OPTION_UNSET: none)
+    int reorderWatermark;
+    // Exits a billing report prints after each command (OPTION_UNSET: all)
+    int reportSlice;
+    // 1 to answer entries/exits, 'v' and 'f' with binary records
+    int binaryOutput;
+    // 1 to hash every answer, binary or text, and write only the digest
+    int digestOutput;
+    // Workers running the batch jobs, counting the main thread
+    int numWorkers;
+    // Event file replayed instead of reading stdin (NULL: none)
+    char* replayPath;
+    // Event files merged by timestamp instead of reading stdin
+    char* feedPaths[MAX_FEEDS];
+    int numFeeds;
+    // File where the commands processed are logged, compressed (NULL: none)
+    char* logPath;
+    // File where the trace is written at the end (NULL: no tracing)
+    char* tracePath;
+    // 1 to write the time and hardware counters of each span kind to stderr
+    int spanStats;
+    // Microseconds from which commands go to the slow log (OPTION_UNSET:
+    // no slow log)
+    int slowThreshold;
+} Config;
+
+
+// Parsing
+int parseConfig(int argc, char* argv[], Config* config);
+#endif
@@ -0,0 +1,151 @@
+/**
+ * Implementation of the functions related to the hardware counters.
+ *
+ * The counters are opened with perf_event_open, in a single group so they
+ * are all read with one system call.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <linux/perf_event.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "counters.h"
+
+// Name of each counter, by index
+const char* COUNTER_NAMES[NUM_COUNTERS] = {
+    "cycles", "instructions", "L1D misses", "LLC misses", "branch misses"
+};
+
+
+/**
+ * @brief Fills the perf_event_open attributes of a counter.
+ *
+ * @param counter Index of the counter.
+ * @param attr Where to store the attributes.
+ */
+void counterAttributes(int counter, struct perf_event_attr* attr){
+    memset(attr, 0, sizeof(*attr));
+    attr->size = sizeof(*attr);
+    attr->type = PERF_TYPE_HARDWARE;
+    attr->read_format = PERF_FORMAT_GROUP;
+    attr->exclude_kernel = 1;
+    attr->exclude_hv = 1;
+
+    switch (counter){
+        case COUNTER_CYCLES:
+            attr->config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case COUNTER_INSTRUCTIONS:
+            attr->config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case COUNTER_L1D_MISSES:
+            attr->type = PERF_TYPE_HW_CACHE;
+            attr->config = PERF_COUNT_HW_CACHE_L1D |
+                (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case COUNTER_LLC_MISSES:
+            attr->config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case COUNTER_BRANCH_MISSES:
+            attr->config = PERF_COUNT_HW_BRANCH_MISSES;
+    }
+}
+
+
+/**
+ * @brief Opens the hardware counters of the calling thread.
+ *
+ * @return Pointer to the counters, or NULL if no counter could be opened.
+ */
+Counters* openCounters(){
+    Counters* counters = (Counters*)malloc(sizeof(Counters));
+    struct perf_event_attr attr;
+    int leader = -1;
+
+    counters->numOpen = 0;
+    counters->owner = pthread_self();
+    for (int c = 0; c < NUM_COUNTERS; c++){
+        counterAttributes(c, &attr);
+        counters->fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1,
+                                        leader, 0);
+        counters->positions[c] = -1;
+        if (counters->fds[c] != -1){
+            counters->positions[c] = counters->numOpen++;
+            if (leader == -1){
+                leader = counters->fds[c];
+            }
+        }
+    }
+
+    if (counters->numOpen == 0){
+        free(counters);
+        return NULL;
+    }
+    counters->leader = leader;
+    return counters;
+}
+
+
+/**
+ * @brief Closes the hardware counters and frees their memory.
+ *
+ * @param counters Pointer to the counters, or NULL.
+ */
+void closeCounters(Counters* counters){
+    if (counters == NULL){
+        return;
+    }
+    for (int c = 0; c < NUM_COUNTERS; c++){
+        if (counters->fds[c] != -1){
+            close(counters->fds[c]);
+        }
+    }
+    free(counters);
+}
+
+
+/**
+ * @brief Checks if the calling thread is the one the counters count.
+ *
+ * @param counters Pointer to the counters.
+ * @return 1 if it is, 0 otherwise.
+ */
+int ownsCounters(const Counters* counters){
+    return pthread_equal(pthread_self(), counters->owner);
+}
+
+
+/**
+ * @brief Reads every counter (0 for the ones that couldn't be opened).
+ *
+ * @param counters Pointer to the counters.
+ * @param values Where to store the value of each counter.
+ */
+void readCounters(const Counters* counters,
+unsigned long long values[NUM_COUNTERS]){
+    // Group read format: number of counters, then their values
+    unsigned long long group[NUM_COUNTERS + 1] = {0};
+
+    if (read(counters->leader, group, sizeof(group)) <= 0){
+        memset(group, 0, sizeof(group));
+    }
+
+    for (int c = 0; c < NUM_COUNTERS; c++){
+        values[c] = (counters->positions[c] != -1) ?
+                    group[counters->positions[c] + 1] : 0;
+    }
+}
+
+
+/**
+ * @brief Retrieves the name of a counter.
+ *
+ * @param counter Index of the counter.
+ * @return The name of the counter.
+ */
+const char* getCounterName(int counter){
+    return COUNTER_NAMES[counter];
+}
@@ -0,0 +1,45 @@
+/**
+ * Definition of the hardware counters struct, and of the function
+ * prototypes related to it.
+ *
+ * The hardware counters are read with perf_event_open, as one group, for
+ * the thread that opened them. Counters the machine (or the kernel's
+ * perf_event_paranoid setting) doesn't allow are left out, and read as 0.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <pthread.h>
+
+// Number of counters
+#define NUM_COUNTERS 5
+// Index of each counter
+#define COUNTER_CYCLES 0
+#define COUNTER_INSTRUCTIONS 1
+#define COUNTER_L1D_MISSES 2
+#define COUNTER_LLC_MISSES 3
+#define COUNTER_BRANCH_MISSES 4
+
+typedef struct counters {
+    int fds[NUM_COUNTERS]; // file descriptor of each counter, or -1
+    int positions[NUM_COUNTERS]; // position of each counter in a group read
+    int numOpen; // counters in the group
+    int leader; // file descriptor of the group leader
+    pthread_t owner; // the only thread the counters count
+} Counters;
+
+
+// Initializer
+Counters* openCounters();
+
+// Free
+void closeCounters(Counters* counters);
+
+// Reading
+int ownsCounters(const Counters* counters);
+void readCounters(const Counters* counters,
+                    unsigned long long values[NUM_COUNTERS]);
+const char* getCounterName(int counter);
+#endif
@@ -0,0 +1,195 @@
+/**
+ * Implementation of the functions related to the duplicate event filter.
+ *
+ * The filter remembers the ids of recently accepted events, in two
+ * generations of a hash set aged by the entries/exits clock.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "dedupe.h"
+
+// Constants of the murmur3 64-bit finalizer
+#define MIX_MUL1 0xFF51AFD7ED558CCDULL
+#define MIX_MUL2 0xC4CEB9FE1A85EC53ULL
+
+
+/**
+ * @brief Empties a generation.
+ *
+ * @param generation Pointer to the generation.
+ * @param minute The clock when the generation becomes the current one.
+ */
+void resetGeneration(DedupeGeneration* generation, int minute){
+    memset(generation->used, 0, generation->numSlots);
+    generation->numIds = 0;
+    generation->startMinute = minute;
+}
+
+
+/**
+ * @brief Allocates the slots of a generation, all of them empty.
+ *
+ * @param generation Pointer to the generation.
+ * @param numSlots Number of slots (a power of 2).
+ */
+void allocateGeneration(DedupeGeneration* generation, unsigned int numSlots){
+    generation->ids = (unsigned long long*)malloc(
+                        numSlots * sizeof(unsigned long long));
+    generation->used = (unsigned char*)calloc(numSlots, 1);
+    generation->numSlots = numSlots;
+    generation->numIds = 0;
+}
+
+
+/**
+ * @brief Creates a new, empty, duplicate event filter.
+ *
+ * @return Pointer to the new filter.
+ */
+DedupeFilter* newDedupeFilter(){
+    DedupeFilter* filter = (DedupeFilter*)malloc(sizeof(DedupeFilter));
+
+    for (int i = 0; i < DEDUPE_GENERATIONS; i++){
+        allocateGeneration(&filter->generations[i], DEDUPE_INITIAL_SLOTS);
+        filter->generations[i].startMinute = 0;
+    }
+    filter->current = 0;
+
+    return filter;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a duplicate event filter.
+ *
+ * @param filter Pointer to the filter.
+ */
+void freeDedupeFilter(DedupeFilter* filter){
+    for (int i = 0; i < DEDUPE_GENERATIONS; i++){
+        free(filter->generations[i].ids);
+        free(filter->generations[i].used);
+    }
+    free(filter);
+}
+
+
+/**
+ * @brief Finds the slot holding an id, or the empty slot where it would be
+ * inserted.
+ *
+ * @param generation Pointer to the generation.
+ * @param id The event id.
+ * @return Index of the slot.
+ */
+unsigned int probeId(const DedupeGeneration* generation,
+unsigned long long id){
+    unsigned long long hash = id;
+
+    hash = (hash ^ (hash >> 33)) * MIX_MUL1;
+    hash = (hash ^ (hash >> 33)) * MIX_MUL2;
+    unsigned int slot = (unsigned int)(hash ^ (hash >> 33)) &
+                        (generation->numSlots - 1);
+
+    // Linear probing, the maximum load guarantees an empty slot exists
+    while (generation->used[slot] && generation->ids[slot] != id){
+        slot = (slot + 1) & (generation->numSlots - 1);
+    }
+    return slot;
+}
+
+
+/**
+ * @brief Doubles the slots of a full generation, keeping its ids.
+ *
+ * @param generation Pointer to the generation.
+ */
+void growGeneration(DedupeGeneration* generation){
+    DedupeGeneration old = *generation;
+
+    allocateGeneration(generation, 2 * old.numSlots);
+    for (unsigned int i = 0; i < old.numSlots; i++){
+        if (old.used[i]){
+            unsigned int slot = probeId(generation, old.ids[i]);
+            generation->used[slot] = 1;
+            generation->ids[slot] = old.ids[i];
+            generation->numIds++;
+        }
+    }
+    free(old.ids);
+    free(old.used);
+}
+
+
+/**
+ * @brief Checks if an event id was recently accepted.
+ *
+ * @param filter Pointer to the filter.
+ * @param id The event id.
+ * @return 1 if the id is remembered, 0 otherwise.
+ */
+int dedupeContains(const DedupeFilter* filter, unsigned long long id){
+    for (int i = 0; i < DEDUPE_GENERATIONS; i++){
+        const DedupeGeneration* generation = &filter->generations[i];
+        if (generation->used[probeId(generation, id)]){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Makes the oldest generation the current one, forgetting its ids.
+ *
+ * @param filter Pointer to the filter.
+ * @param minute The current clock.
+ */
+void rotateGenerations(DedupeFilter* filter, int minute){
+    filter->current = (filter->current + 1) % DEDUPE_GENERATIONS;
+    resetGeneration(&filter->generations[filter->current], minute);
+}
+
+
+/**
+ * @brief Remembers an accepted event id.
+ *
+ * The generations are aged first: once the current one is older than
+ * DEDUPE_WINDOW_MINUTES, the oldest one is forgotten. A full current
+ * generation grows instead, as its ids are still within the window, unless
+ * it has DEDUPE_MAX_SLOTS already: then the oldest one is forgotten early.
+ *
+ * @param filter Pointer to the filter.
+ * @param id The event id.
+ * @param minute The clock of the event (minutes of its timestamp).
+ */
+void dedupeInsert(DedupeFilter* filter, unsigned long long id, int minute){
+    DedupeGeneration* current = &filter->generations[filter->current];
+
+    if (minute - current->startMinute >= DEDUPE_WINDOW_MINUTES){
+        // After a long quiet period both generations are stale
+        if (minute - current->startMinute >= 2 * DEDUPE_WINDOW_MINUTES){
+            rotateGenerations(filter, minute);
+        }
+        rotateGenerations(filter, minute);
+        current = &filter->generations[filter->current];
+    }
+    if (current->numIds == DEDUPE_MAX_IDS(current->numSlots)){
+        if (current->numSlots < DEDUPE_MAX_SLOTS){
+            growGeneration(current);
+        }
+        else {
+            // The window shrinks instead of the memory growing any further
+            rotateGenerations(filter, minute);
+            current = &filter->generations[filter->current];
+        }
+    }
+
+    unsigned int slot = probeId(current, id);
+    if (!current->used[slot]){
+        current->used[slot] = 1;
+        current->ids[slot] = id;
+        current->numIds++;
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * Definition of the duplicate event filter structs, and of the related
+ * function prototypes.
+ *
+ * The filter remembers the ids of recently accepted events so a retried
+ * command can be recognised and dropped. Ids are kept in two generations
+ * of a hash set: when the current generation gets older than
+ * DEDUPE_WINDOW_MINUTES (by the chronological clock of the entries and
+ * exits), the oldest generation is forgotten. A generation filling up
+ * within the window doubles its slots instead, so ids are remembered for
+ * the whole window, up to DEDUPE_MAX_SLOTS slots. Forgotten generations
+ * keep their slots, so memory only grows with the most ids accepted in a
+ * window.
+ *
+ * A generation filling up its DEDUPE_MAX_SLOTS slots is rotated early
+ * instead: past DEDUPE_MAX_IDS(DEDUPE_MAX_SLOTS) ids per window, ids are
+ * remembered for less than the window, but at least the last
+ * DEDUPE_MAX_IDS(DEDUPE_MAX_SLOTS) of them still are. The filter keeps at
+ * most DEDUPE_GENERATIONS * DEDUPE_MAX_SLOTS * 9 bytes (an id and a used
+ * flag per slot), 18 MB, plus the old slots while a generation grows.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef DEDUPE_H
+#define DEDUPE_H
+
+// Minutes an event id is remembered for, at least
+#define DEDUPE_WINDOW_MINUTES 60
+// Initial number of slots of each generation (a power of 2)
+#define DEDUPE_INITIAL_SLOTS 4096
+// Most slots of each generation (a power of 2), see above
+#define DEDUPE_MAX_SLOTS (1u << 20)
+// Maximum ids in n slots, keeping probe sequences short (3/4 load)
+#define DEDUPE_MAX_IDS(n) ((n) / 4 * 3)
+// Number of generations kept
+#define DEDUPE_GENERATIONS 2
+
+typedef struct dedupeGeneration {
+    unsigned long long* ids;
+    unsigned char* used; // 1 if the slot holds an id
+    unsigned int numSlots; // always a power of 2
+    unsigned int numIds;
+    int startMinute; // clock when the generation became the current one
+} DedupeGeneration;
+
+typedef struct dedupeFilter {
+    DedupeGeneration generations[DEDUPE_GENERATIONS];
+    int current; // index of the generation receiving new ids
+} DedupeFilter;
+
+
+// Initializer
+DedupeFilter* newDedupeFilter();
+
+// Free
+void freeDedupeFilter(DedupeFilter* filter);
+
+// Lookup and insertion
+int dedupeContains(const DedupeFilter* filter, unsigned long long id);
+void dedupeInsert(DedupeFilter* filter, unsigned long long id, int minute);
+#endif
@@ -0,0 +1,115 @@
+/**
+ * Implementation of the functions related to digests.
+ *
+ * The lanes are mixed as in the tail of xxHash64, and the final value
+ * goes through its avalanche.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <string.h>
+#include "digest.h"
+
+// Primes of xxHash64
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+
+/**
+ * @brief Rotates a 64-bit value to the left.
+ *
+ * @param value The value.
+ * @param bits Number of bits to rotate (1 to 63).
+ * @return The rotated value.
+ */
+unsigned long long rotateLeft(unsigned long long value, int bits){
+    return (value << bits) | (value >> (64 - bits));
+}
+
+
+/**
+ * @brief Mixes a full lane into the hash.
+ *
+ * @param hash The hash.
+ * @param lane The lane's bytes.
+ * @return The new hash.
+ */
+unsigned long long mixLane(unsigned long long hash,
+const unsigned char lane[DIGEST_LANE]){
+    unsigned long long value;
+
+    memcpy(&value, lane, DIGEST_LANE);
+    value *= PRIME64_2;
+    value = rotateLeft(value, 31) * PRIME64_1;
+    hash ^= value;
+    return rotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+}
+
+
+/**
+ * @brief Initializes an empty digest.
+ *
+ * @param digest Pointer to the digest.
+ */
+void initDigest(Digest* digest){
+    digest->hash = PRIME64_5;
+    digest->length = 0;
+    digest->numPending = 0;
+}
+
+
+/**
+ * @brief Adds bytes to a digest.
+ *
+ * @param digest Pointer to the digest.
+ * @param data Pointer to the bytes.
+ * @param length Number of bytes.
+ */
+void digestUpdate(Digest* digest, const void* data, unsigned long length){
+    const unsigned char* bytes = (const unsigned char*)data;
+
+    digest->length += length;
+    // Complete the lane started by the previous updates
+    while (length > 0 && digest->numPending > 0){
+        digest->pending[digest->numPending++] = *bytes++;
+        length--;
+        if (digest->numPending == DIGEST_LANE){
+            digest->hash = mixLane(digest->hash, digest->pending);
+            digest->numPending = 0;
+        }
+    }
+    if (digest->numPending > 0){
+        return;
+    }
+
+    for (; length >= DIGEST_LANE; bytes += DIGEST_LANE, length -= DIGEST_LANE){
+        digest->hash = mixLane(digest->hash, bytes);
+    }
+    memcpy(digest->pending, bytes, length);
+    digest->numPending = length;
+}
+
+
+/**
+ * @brief Computes the value of a digest, from the bytes added so far.
+ *
+ * @param digest Pointer to the digest (it can still be updated after).
+ * @return The 64-bit hash.
+ */
+unsigned long long digestValue(const Digest* digest){
+    unsigned long long hash = digest->hash + digest->length;
+
+    for (unsigned int i = 0; i < digest->numPending; i++){
+        hash ^= digest->pending[i] * PRIME64_5;
+        hash = rotateLeft(hash, 11) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,33 @@
+/**
+ * Definition of the digest struct, and of the function prototypes related
+ * to it.
+ *
+ * A digest is a running 64-bit hash of a byte stream, in the style of
+ * xxHash64: the stream is consumed 8 bytes at a time, so the result only
+ * depends on the bytes and not on how they were split between updates.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef DIGEST_H
+#define DIGEST_H
+
+// Number of bytes consumed at a time
+#define DIGEST_LANE 8
+
+typedef struct digest {
+    unsigned long long hash;
+    unsigned long long length; // bytes hashed so far
+    unsigned char pending[DIGEST_LANE]; // bytes waiting for a full lane
+    unsigned int numPending;
+} Digest;
+
+
+// Initializer
+void initDigest(Digest* digest);
+
+// Updates
+void digestUpdate(Digest* digest, const void* data, unsigned long length);
+
+// Result
+unsigned long long digestValue(const Digest* digest);
+#endif
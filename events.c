@@ -0,0 +1,361 @@
+/**
+ * Implementation of the functions related to the event bus.
+ *
+ * Subscribers register interest in a plate or in a park's occupancy, and
+ * matching events are pushed to their lock-free ring buffers.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "events.h"
+
+// Initial value for the hash in the djb2 algorithm
+#define NAME_HASH_SEED 5381
+
+
+/**
+ * @brief Creates a new event bus without subscribers.
+ *
+ * @return Pointer to the new event bus.
+ */
+EventBus* newEventBus(){
+    EventBus* bus = (EventBus*)malloc(sizeof(EventBus));
+
+    bus->subscribers = NULL;
+    bus->plateSubscribers = NULL;
+    bus->plateSubscribersSize = 0;
+    memset(bus->parkSubscribers, 0, sizeof(bus->parkSubscribers));
+    bus->nextId = 1;
+
+    return bus;
+}
+
+
+/**
+ * @brief Frees the memory allocated for an event bus and its subscribers.
+ *
+ * @param bus Pointer to the event bus.
+ */
+void freeEventBus(EventBus* bus){
+    while (bus->subscribers != NULL){
+        Subscriber* next = bus->subscribers->next;
+        free(bus->subscribers->parkName);
+        free(bus->subscribers);
+        bus->subscribers = next;
+    }
+    free(bus->plateSubscribers);
+    free(bus);
+}
+
+
+/**
+ * @brief Calculates the bucket of a park name in the park subscriptions.
+ *
+ * @param parkName The name of the park.
+ * @return The bucket of the park name (djb2 hash).
+ */
+unsigned int parkNameBucket(const char* parkName){
+    unsigned int hash = NAME_HASH_SEED;
+
+    while (*parkName){
+        hash = ((hash << 5) + hash) + (unsigned char)*parkName++;
+    }
+    return hash % PARK_SUBSCRIPTION_BUCKETS;
+}
+
+
+/**
+ * @brief Creates a subscriber with an empty ring buffer and adds it to the
+ * bus's list of subscribers.
+ *
+ * @param bus Pointer to the event bus.
+ * @return Pointer to the new subscriber.
+ */
+Subscriber* newSubscriber(EventBus* bus){
+    Subscriber* subscriber = (Subscriber*)malloc(sizeof(Subscriber));
+
+    subscriber->id = bus->nextId++;
+    subscriber->plateId = NO_PLATE_ID;
+    subscriber->parkName = NULL;
+    subscriber->threshold = 0;
+    atomic_init(&subscriber->ring.head, 0);
+    atomic_init(&subscriber->ring.tail, 0);
+    atomic_init(&subscriber->ring.dropped, 0);
+    subscriber->nextMatch = NULL;
+
+    subscriber->next = bus->subscribers;
+    bus->subscribers = subscriber;
+    return subscriber;
+}
+
+
+/**
+ * @brief Subscribes to the entries and exits of a plate.
+ *
+ * @param bus Pointer to the event bus.
+ * @param plateId The id of the plate to watch.
+ * @return Pointer to the new subscriber.
+ */
+Subscriber* subscribePlate(EventBus* bus, unsigned int plateId){
+    Subscriber* subscriber = newSubscriber(bus);
+    subscriber->plateId = plateId;
+
+    // Grow the plate index so plateId fits in it
+    if (plateId >= bus->plateSubscribersSize){
+        unsigned int newSize = bus->plateSubscribersSize ?
+                                bus->plateSubscribersSize : 1;
+        while (newSize <= plateId){
+            newSize *= 2;
+        }
+        bus->plateSubscribers = (Subscriber**)realloc(bus->plateSubscribers,
+                                    newSize * sizeof(Subscriber*));
+        memset(bus->plateSubscribers + bus->plateSubscribersSize, 0,
+                (newSize - bus->plateSubscribersSize) * sizeof(Subscriber*));
+        bus->plateSubscribersSize = newSize;
+    }
+
+    subscriber->nextMatch = bus->plateSubscribers[plateId];
+    bus->plateSubscribers[plateId] = subscriber;
+    return subscriber;
+}
+
+
+/**
+ * @brief Subscribes to a park's occupancy reaching, or going back under,
+ * a threshold.
+ *
+ * @param bus Pointer to the event bus.
+ * @param parkName The name of the park to watch (it is copied).
+ * @param threshold The number of vehicles inside the park to watch for.
+ * @return Pointer to the new subscriber.
+ */
+Subscriber* subscribePark(EventBus* bus, const char* parkName,
+int threshold){
+    Subscriber* subscriber = newSubscriber(bus);
+    unsigned int bucket = parkNameBucket(parkName);
+
+    subscriber->parkName = (char*)malloc(strlen(parkName) + 1);
+    strcpy(subscriber->parkName, parkName);
+    subscriber->threshold = threshold;
+
+    subscriber->nextMatch = bus->parkSubscribers[bucket];
+    bus->parkSubscribers[bucket] = subscriber;
+    return subscriber;
+}
+
+
+/**
+ * @brief Closes the subscriptions to a park's occupancy, when the park is
+ * removed.
+ *
+ * The subscribers stop matching the park, so a later park with the same
+ * name isn't watched, but keep the events already in their buffers.
+ *
+ * @param bus Pointer to the event bus.
+ * @param parkName The name of the park.
+ */
+void closeParkSubscriptions(EventBus* bus, const char* parkName){
+    Subscriber** link = &bus->parkSubscribers[parkNameBucket(parkName)];
+
+    while (*link != NULL){
+        if (strcmp((*link)->parkName, parkName) == 0){
+            Subscriber* closed = *link;
+            *link = closed->nextMatch;
+            closed->nextMatch = NULL;
+        }
+        else{
+            link = &(*link)->nextMatch;
+        }
+    }
+}
+
+
+/**
+ * @brief Retrieves the subscriber with the given id.
+ *
+ * @param bus Pointer to the event bus.
+ * @param id The id of the subscriber.
+ * @return Pointer to the subscriber, or NULL if it doesn't exist.
+ */
+Subscriber* getSubscriber(EventBus* bus, int id){
+    Subscriber* subscriber = bus->subscribers;
+
+    while (subscriber != NULL && subscriber->id != id){
+        subscriber = subscriber->next;
+    }
+    return subscriber;
+}
+
+
+/**
+ * @brief Pushes an event to a ring buffer, without ever waiting.
+ *
+ * Only the producer writes head, and only the consumer writes tail, so
+ * the buffer needs no locks.
+ *
+ * @param ring Pointer to the ring buffer.
+ * @param event Pointer to the event to push.
+ * @return 1 if the event was pushed, 0 if it was dropped (buffer full).
+ */
+int pushEvent(RingBuffer* ring, const Event* event){
+    unsigned long head = atomic_load_explicit(&ring->head,
+                                                memory_order_relaxed);
+    unsigned long tail = atomic_load_explicit(&ring->tail,
+                                                memory_order_acquire);
+
+    if (head - tail == RING_SIZE){
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    ring->events[head & (RING_SIZE - 1)] = *event;
+    // Publish the event only after it is fully written
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 1;
+}
+
+
+/**
+ * @brief Pops the oldest event of a ring buffer.
+ *
+ * @param ring Pointer to the ring buffer.
+ * @param event Where to copy the popped event.
+ * @return 1 if an event was popped, 0 if the buffer was empty.
+ */
+int popEvent(RingBuffer* ring, Event* event){
+    unsigned long tail = atomic_load_explicit(&ring->tail,
+                                                memory_order_relaxed);
+    unsigned long head = atomic_load_explicit(&ring->head,
+                                                memory_order_acquire);
+
+    if (tail == head){
+        return 0;
+    }
+
+    *event = ring->events[tail & (RING_SIZE - 1)];
+    // Free the slot only after the event is fully read
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+
+/**
+ * @brief Retrieves and resets the number of events dropped by a ring buffer.
+ *
+ * @param ring Pointer to the ring buffer.
+ * @return The number of events dropped since the last call.
+ */
+unsigned long takeDropped(RingBuffer* ring){
+    return atomic_exchange_explicit(&ring->dropped, 0, memory_order_relaxed);
+}
+
+
+/**
+ * @brief Builds an event.
+ *
+ * Park names longer than EVENT_PARK_NAME_LENGTH - 1 bytes are truncated.
+ *
+ * @param event Pointer to the event to fill.
+ * @param type The type of the event.
+ * @param plate The plate of the vehicle (empty for threshold events).
+ * @param parkName The name of the park.
+ * @param occupancy The number of vehicles inside the park after the event.
+ * @param timestamp Pointer to the timestamp of the event.
+ */
+void fillEvent(Event* event, char type, const char* plate,
+const char* parkName, int occupancy, const Timestamp* timestamp){
+    event->type = type;
+    strcpy(event->plate, plate);
+    snprintf(event->parkName, EVENT_PARK_NAME_LENGTH, "%s", parkName);
+    event->occupancy = occupancy;
+    copyTimestamp(&event->timestamp, timestamp);
+}
+
+
+/**
+ * @brief Publishes the threshold events of a park's occupancy change.
+ *
+ * @param bus Pointer to the event bus.
+ * @param type EVENT_ENTRY or EVENT_EXIT, the change of occupancy.
+ * @param parkName The name of the park.
+ * @param occupancy The number of vehicles inside the park after the change.
+ * @param timestamp Pointer to the timestamp of the change.
+ */
+void publishOccupancy(EventBus* bus, char type, const char* parkName,
+int occupancy, const Timestamp* timestamp){
+    Subscriber* subscriber = bus->parkSubscribers[parkNameBucket(parkName)];
+    Event event;
+    int built = 0;
+
+    for (; subscriber != NULL; subscriber = subscriber->nextMatch){
+        // An entry crosses the threshold when it is reached, an exit when
+        // the occupancy falls back under it
+        int crossed = (type == EVENT_ENTRY) ?
+            occupancy == subscriber->threshold :
+            occupancy == subscriber->threshold - 1;
+        if (!crossed || strcmp(subscriber->parkName, parkName) != 0){
+            continue;
+        }
+        if (!built){
+            fillEvent(&event, type == EVENT_ENTRY ? EVENT_ABOVE : EVENT_BELOW,
+                        "", parkName, occupancy, timestamp);
+            built = 1;
+        }
+        pushEvent(&subscriber->ring, &event);
+    }
+}
+
+
+/**
+ * @brief Publishes a vehicle entry or exit to the matching subscribers.
+ *
+ * @param bus Pointer to the event bus.
+ * @param type EVENT_ENTRY or EVENT_EXIT.
+ * @param plateId The id of the vehicle's plate.
+ * @param plate The plate of the vehicle.
+ * @param parkName The name of the park.
+ * @param occupancy The number of vehicles inside the park after the event.
+ * @param timestamp Pointer to the timestamp of the event.
+ */
+void publishEntryExit(EventBus* bus, char type, unsigned int plateId,
+const char plate[PLATE_LENGTH], const char* parkName, int occupancy,
+const Timestamp* timestamp){
+    if (plateId < bus->plateSubscribersSize &&
+        bus->plateSubscribers[plateId] != NULL){
+        Event event;
+        fillEvent(&event, type, plate, parkName, occupancy, timestamp);
+
+        Subscriber* subscriber = bus->plateSubscribers[plateId];
+        for (; subscriber != NULL; subscriber = subscriber->nextMatch){
+            pushEvent(&subscriber->ring, &event);
+        }
+    }
+
+    publishOccupancy(bus, type, parkName, occupancy, timestamp);
+}
+
+
+/**
+ * @brief Prints an event.
+ *
+ * Entries and exits are printed as <plate> entry|exit <park> <date> <hour>
+ * and threshold crossings as <park> above|below <occupancy> <date> <hour>.
+ *
+ * @param event Pointer to the event.
+ */
+void printEvent(const Event* event){
+    if (event->type == EVENT_ENTRY || event->type == EVENT_EXIT){
+        printPlate(event->plate);
+        printf(" %s %s ", event->type == EVENT_ENTRY ? "entry" : "exit",
+                event->parkName);
+    }
+    else{
+        printf("%s %s %d ", event->parkName,
+                event->type == EVENT_ABOVE ? "above" : "below",
+                event->occupancy);
+    }
+    printTimestamp(&event->timestamp);
+    printf("\n");
+}
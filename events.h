@@ -0,0 +1,91 @@
+/**
+ * Definition of the event bus structs, and of the function prototypes
+ * related to them.
+ *
+ * Subscribers register interest in a plate (its entries and exits) or in a
+ * park (its occupancy crossing a threshold). Matching events are pushed to
+ * each subscriber's ring buffer, which never blocks the publisher: when a
+ * slow subscriber's buffer is full the event is dropped and counted.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include <stdatomic.h>
+#include "platedict.h"
+#include "timestamp.h"
+
+// Number of events each subscriber's ring buffer holds (a power of 2)
+#define RING_SIZE 1024
+// Number of buckets of the park subscriptions hashtable
+#define PARK_SUBSCRIPTION_BUCKETS 64
+// Maximum bytes of a park name kept in an event (including the \0)
+#define EVENT_PARK_NAME_LENGTH 64
+
+// Event types
+#define EVENT_ENTRY 'e'
+#define EVENT_EXIT 's'
+#define EVENT_ABOVE '+' // occupancy reached the threshold
+#define EVENT_BELOW '-' // occupancy went back under the threshold
+
+typedef struct event {
+    char type;
+    char plate[PLATE_LENGTH];
+    char parkName[EVENT_PARK_NAME_LENGTH];
+    int occupancy; // vehicles inside the park after the event
+    Timestamp timestamp;
+} Event;
+
+// Single producer, single consumer, lock-free queue of events
+typedef struct ringBuffer {
+    Event events[RING_SIZE];
+    atomic_ulong head; // total events pushed (written by the producer)
+    atomic_ulong tail; // total events popped (written by the consumer)
+    atomic_ulong dropped; // events lost because the buffer was full
+} RingBuffer;
+
+typedef struct subscriber {
+    int id;
+    unsigned int plateId; // watched plate, or NO_PLATE_ID
+    char* parkName; // watched park, or NULL
+    int threshold; // occupancy threshold of the watched park
+    RingBuffer ring;
+    struct subscriber* nextMatch; // next subscriber of the same plate/park
+    struct subscriber* next; // next subscriber of the bus
+} Subscriber;
+
+typedef struct eventBus {
+    Subscriber* subscribers; // every subscriber, by creation order
+    Subscriber** plateSubscribers; // indexed by plate id
+    unsigned int plateSubscribersSize; // allocated length
+    Subscriber* parkSubscribers[PARK_SUBSCRIPTION_BUCKETS];
+    int nextId;
+} EventBus;
+
+
+// Initializer
+EventBus* newEventBus();
+
+// Free
+void freeEventBus(EventBus* bus);
+
+// Subscriptions
+Subscriber* subscribePlate(EventBus* bus, unsigned int plateId);
+Subscriber* subscribePark(EventBus* bus, const char* parkName,
+                            int threshold);
+void closeParkSubscriptions(EventBus* bus, const char* parkName);
+Subscriber* getSubscriber(EventBus* bus, int id);
+
+// Publishing
+void publishEntryExit(EventBus* bus, char type, unsigned int plateId,
+                        const char plate[PLATE_LENGTH], const char* parkName,
+                        int occupancy, const Timestamp* timestamp);
+void publishOccupancy(EventBus* bus, char type, const char* parkName,
+                        int occupancy, const Timestamp* timestamp);
+
+// Consuming
+int popEvent(RingBuffer* ring, Event* event);
+unsigned long takeDropped(RingBuffer* ring);
+void printEvent(const Event* event);
+#endif
@@ -0,0 +1,382 @@
+/**
+ * Implementation of the functions related to exit trees.
+ *
+ * The exits of a park are a treap, whose priorities are a hash of the
+ * node's position, and whose nodes are chained in order.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "exittree.h"
+
+// Multipliers of the hash giving the priority of a node
+#define EXIT_PRIORITY_MUL1 0x7FEB352Du
+#define EXIT_PRIORITY_MUL2 0x846CA68Bu
+
+
+/**
+ * @brief Creates a new, empty, exit tree.
+ *
+ * @return Pointer to the new exit tree.
+ */
+ExitTree* newExitTree(){
+    ExitTree* tree = (ExitTree*)malloc(sizeof(ExitTree));
+
+    tree->capacity = EXIT_TREE_INITIAL_NODES;
+    tree->nodes = (ExitNode*)malloc(tree->capacity * sizeof(ExitNode));
+    tree->nodes[EXIT_NO_NODE] = (ExitNode){NULL, EXIT_NO_NODE, EXIT_NO_NODE,
+                                            0, EXIT_NO_NODE};
+    tree->numNodes = 1;
+    tree->root = EXIT_NO_NODE;
+    tree->first = EXIT_NO_NODE;
+
+    return tree;
+}
+
+
+/**
+ * @brief Frees the memory allocated for an exit tree (not its logs).
+ *
+ * @param tree Pointer to the exit tree.
+ */
+void freeExitTree(ExitTree* tree){
+    free(tree->nodes);
+    free(tree);
+}
+
+
+/**
+ * @brief Calculates the priority of a node in the treap.
+ *
+ * @param node The node.
+ * @return The priority, a hash of the node's position.
+ */
+unsigned int exitPriority(unsigned int node){
+    node = (node ^ (node >> 16)) * EXIT_PRIORITY_MUL1;
+    node = (node ^ (node >> 15)) * EXIT_PRIORITY_MUL2;
+    return node ^ (node >> 16);
+}
+
+
+/**
+ * @brief Checks if an exit comes before another in the tree.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param a The node of the first exit.
+ * @param b The node of the second exit.
+ * @return 1 if a's exit is earlier than b's, or at the same minute but added
+ * first, 0 otherwise.
+ */
+int exitBefore(const ExitTree* tree, unsigned int a, unsigned int b){
+    int order = compareTimestamps(getExitTimestamp(tree->nodes[a].log),
+                                    getExitTimestamp(tree->nodes[b].log));
+
+    return order < 0 || (order == 0 && a < b);
+}
+
+
+/**
+ * @brief Recounts the nodes in a subtree from the ones of its children.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param node The root of the subtree.
+ */
+void updateExitSize(ExitTree* tree, unsigned int node){
+    ExitNode* n = &tree->nodes[node];
+
+    n->size = tree->nodes[n->left].size + tree->nodes[n->right].size + 1;
+}
+
+
+/**
+ * @brief Splits a subtree into the exits before a node and the others.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param subtree The root of the subtree.
+ * @param node The node splitting the subtree (not in it).
+ * @param before Where to store the root of the exits before the node.
+ * @param after Where to store the root of the exits after the node.
+ */
+void splitExits(ExitTree* tree, unsigned int subtree, unsigned int node,
+unsigned int* before, unsigned int* after){
+    if (subtree == EXIT_NO_NODE){
+        *before = *after = EXIT_NO_NODE;
+        return;
+    }
+
+    ExitNode* root = &tree->nodes[subtree];
+    if (exitBefore(tree, subtree, node)){
+        splitExits(tree, root->right, node, &root->right, after);
+        *before = subtree;
+    }
+    else {
+        splitExits(tree, root->left, node, before, &root->left);
+        *after = subtree;
+    }
+    updateExitSize(tree, subtree);
+}
+
+
+/**
+ * @brief Merges two subtrees, every exit of the first being before the
+ * exits of the second.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param first The root of the first subtree.
+ * @param second The root of the second subtree.
+ * @return The root of the merged subtree.
+ */
+unsigned int mergeExits(ExitTree* tree, unsigned int first,
+unsigned int second){
+    if (first == EXIT_NO_NODE || second == EXIT_NO_NODE){
+        return first == EXIT_NO_NODE ? second : first;
+    }
+
+    if (exitPriority(first) > exitPriority(second)){
+        unsigned int right = mergeExits(tree, tree->nodes[first].right,
+                                        second);
+        tree->nodes[first].right = right;
+        updateExitSize(tree, first);
+        return first;
+    }
+    unsigned int left = mergeExits(tree, first, tree->nodes[second].left);
+    tree->nodes[second].left = left;
+    updateExitSize(tree, second);
+    return second;
+}
+
+
+/**
+ * @brief Inserts a node in a subtree.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param subtree The root of the subtree.
+ * @param node The node, without children.
+ * @return The root of the subtree with the node.
+ */
+unsigned int insertExitNode(ExitTree* tree, unsigned int subtree,
+unsigned int node){
+    if (subtree == EXIT_NO_NODE){
+        return node;
+    }
+
+    ExitNode* root = &tree->nodes[subtree];
+    if (exitPriority(node) > exitPriority(subtree)){
+        // The node takes the subtree's place, splitting it in two
+        ExitNode* n = &tree->nodes[node];
+        splitExits(tree, subtree, node, &n->left, &n->right);
+        updateExitSize(tree, node);
+        return node;
+    }
+    if (exitBefore(tree, node, subtree)){
+        root->left = insertExitNode(tree, root->left, node);
+    }
+    else {
+        root->right = insertExitNode(tree, root->right, node);
+    }
+    root->size++;
+    return subtree;
+}
+
+
+/**
+ * @brief Removes a node from a subtree.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param subtree The root of the subtree, which must hold the node.
+ * @param node The node.
+ * @return The root of the subtree without the node.
+ */
+unsigned int removeExitNode(ExitTree* tree, unsigned int subtree,
+unsigned int node){
+    ExitNode* root = &tree->nodes[subtree];
+
+    if (subtree == node){
+        return mergeExits(tree, root->left, root->right);
+    }
+    if (exitBefore(tree, node, subtree)){
+        root->left = removeExitNode(tree, root->left, node);
+    }
+    else {
+        root->right = removeExitNode(tree, root->right, node);
+    }
+    root->size--;
+    return subtree;
+}
+
+
+/**
+ * @brief Finds the node of the exit right before a node's.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param node The node (in the tree or not).
+ * @return The node of the previous exit, or EXIT_NO_NODE if there is none.
+ */
+unsigned int findPreviousExit(const ExitTree* tree, unsigned int node){
+    unsigned int subtree = tree->root;
+    unsigned int previous = EXIT_NO_NODE;
+
+    while (subtree != EXIT_NO_NODE){
+        if (exitBefore(tree, subtree, node)){
+            previous = subtree;
+            subtree = tree->nodes[subtree].right;
+        }
+        else {
+            subtree = tree->nodes[subtree].left;
+        }
+    }
+    return previous;
+}
+
+
+/**
+ * @brief Adds the exit of a log, after the exits at the same minute.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param log Pointer to the log, with its exit timestamp.
+ */
+void addExitToTree(ExitTree* tree, Log* log){
+    if (tree->numNodes == tree->capacity){
+        tree->capacity *= 2;
+        tree->nodes = (ExitNode*)realloc(tree->nodes,
+                                        tree->capacity * sizeof(ExitNode));
+    }
+    unsigned int node = tree->numNodes++;
+    ExitNode* n = &tree->nodes[node];
+    n->log = log;
+    n->left = n->right = EXIT_NO_NODE;
+    n->size = 1;
+    log->exitNode = node;
+
+    // Chain it after the previous exit
+    unsigned int previous = findPreviousExit(tree, node);
+    unsigned int* link = (previous == EXIT_NO_NODE) ?
+                            &tree->first : &tree->nodes[previous].next;
+    n->next = *link;
+    *link = node;
+
+    tree->root = insertExitNode(tree, tree->root, node);
+}
+
+
+/**
+ * @brief Removes the exit of a log.
+ *
+ * The log's exit timestamp must be the one it was added with.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param log Pointer to the log, which must be in the tree.
+ */
+void removeExitFromTree(ExitTree* tree, Log* log){
+    unsigned int node = log->exitNode;
+    unsigned int previous = findPreviousExit(tree, node);
+    unsigned int* link = (previous == EXIT_NO_NODE) ?
+                            &tree->first : &tree->nodes[previous].next;
+
+    *link = tree->nodes[node].next;
+    tree->root = removeExitNode(tree, tree->root, node);
+    log->exitNode = EXIT_NO_NODE;
+}
+
+
+/**
+ * @brief Retrieves the number of exits in the tree.
+ *
+ * @param tree Pointer to the exit tree.
+ * @return The number of exits.
+ */
+unsigned int getExitTreeSize(const ExitTree* tree){
+    return tree->nodes[tree->root].size;
+}
+
+
+/**
+ * @brief Retrieves the log of the exit at a position.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param index Position of the exit (less than getExitTreeSize).
+ * @return Pointer to the log of the exit.
+ */
+Log* getExitTreeLogAt(const ExitTree* tree, unsigned int index){
+    unsigned int subtree = tree->root;
+
+    for (;;){
+        const ExitNode* n = &tree->nodes[subtree];
+        unsigned int leftSize = tree->nodes[n->left].size;
+        if (index == leftSize){
+            return n->log;
+        }
+        if (index < leftSize){
+            subtree = n->left;
+        }
+        else {
+            index -= leftSize + 1;
+            subtree = n->right;
+        }
+    }
+}
+
+
+/**
+ * @brief Retrieves the log of the exit after a log's.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param log Pointer to the log, which must be in the tree.
+ * @return Pointer to the log of the next exit, or NULL if it's the last.
+ */
+Log* getExitTreeNextLog(const ExitTree* tree, const Log* log){
+    return tree->nodes[tree->nodes[log->exitNode].next].log;
+}
+
+
+/**
+ * @brief Counts the exits before a day.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param date Pointer to the timestamp of the day.
+ * @return The number of exits before the day, which is also the position
+ * of the first exit in it or after it.
+ */
+unsigned int countExitsBefore(const ExitTree* tree, const Timestamp* date){
+    unsigned int subtree = tree->root;
+    unsigned int count = 0;
+
+    while (subtree != EXIT_NO_NODE){
+        const ExitNode* n = &tree->nodes[subtree];
+        if (compareDate(getExitTimestamp(n->log), date) < 0){
+            count += tree->nodes[n->left].size + 1;
+            subtree = n->right;
+        }
+        else {
+            subtree = n->left;
+        }
+    }
+    return count;
+}
+
+
+/**
+ * @brief Counts the exits before a day or in it.
+ *
+ * @param tree Pointer to the exit tree.
+ * @param date Pointer to the timestamp of the day.
+ * @return The number of exits until the end of the day, which is also the
+ * position of the first exit after it.
+ */
+unsigned int countExitsUntil(const ExitTree* tree, const Timestamp* date){
+    unsigned int subtree = tree->root;
+    unsigned int count = 0;
+
+    while (subtree != EXIT_NO_NODE){
+        const ExitNode* n = &tree->nodes[subtree];
+        if (compareDate(getExitTimestamp(n->log), date) <= 0){
+            count += tree->nodes[n->left].size + 1;
+            subtree = n->right;
+        }
+        else {
+            subtree = n->left;
+        }
+    }
+    return count;
+}
\ No newline at end of file
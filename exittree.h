@@ -0,0 +1,60 @@
+/**
+ * Definition of the exit tree structs, and of the function prototypes
+ * related to them.
+ *
+ * An exit tree keeps the logs with an exit of a park, by chronological
+ * order of the exit, exits at the same minute in the order they were added.
+ * It's a treap whose nodes count their subtree, so adding or removing an
+ * exit anywhere, finding the exit at a position and counting the exits
+ * before a day all take O(log n) expected time. The nodes are also chained
+ * in order, so going through the exits takes O(1) per exit.
+ *
+ * Nodes live in an array, referenced by their position, and a node's
+ * position is also its order among the exits at the same minute. Removed
+ * nodes aren't reused: like voided logs, they live until the tree is freed.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef EXITTREE_H
+#define EXITTREE_H
+
+#include "log.h"
+
+// No node: the empty subtree, and the end of the chain (never a real node)
+#define EXIT_NO_NODE 0
+// Initial length of the nodes array (including EXIT_NO_NODE)
+#define EXIT_TREE_INITIAL_NODES 16
+
+typedef struct exitNode {
+    Log* log; // NULL for EXIT_NO_NODE
+    unsigned int left, right; // children (EXIT_NO_NODE if none)
+    unsigned int size; // nodes in the subtree (0 for EXIT_NO_NODE)
+    unsigned int next; // node of the next exit (EXIT_NO_NODE if last)
+} ExitNode;
+
+typedef struct exitTree {
+    ExitNode* nodes;
+    unsigned int numNodes; // used nodes, removed ones included
+    unsigned int capacity; // allocated length of nodes
+    unsigned int root;
+    unsigned int first; // node of the first exit (EXIT_NO_NODE if none)
+} ExitTree;
+
+
+// Initializer
+ExitTree* newExitTree();
+
+// Free
+void freeExitTree(ExitTree* tree);
+
+// Adding and removing exits
+void addExitToTree(ExitTree* tree, Log* log);
+void removeExitFromTree(ExitTree* tree, Log* log);
+
+// Getters
+unsigned int getExitTreeSize(const ExitTree* tree);
+Log* getExitTreeLogAt(const ExitTree* tree, unsigned int index);
+Log* getExitTreeNextLog(const ExitTree* tree, const Log* log);
+unsigned int countExitsBefore(const ExitTree* tree, const Timestamp* date);
+unsigned int countExitsUntil(const ExitTree* tree, const Timestamp* date);
+#endif
\ No newline at end of file
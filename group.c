@@ -0,0 +1,179 @@
+/**
+ * Implementation of the functions related to park groups.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "group.h"
+
+
+/**
+ * @brief Creates a new, empty, park group.
+ *
+ * @param name The name of the group (allocated, owned by the group).
+ * @return Pointer to the new park group.
+ */
+ParkGroup* newParkGroup(char* name){
+    ParkGroup* group = (ParkGroup*)malloc(sizeof(ParkGroup));
+
+    group->name = name;
+    group->numParks = 0;
+    group->capacity = 0;
+    group->occupied = 0;
+    group->revenue = 0;
+    group->next = NULL;
+
+    return group;
+}
+
+
+/**
+ * @brief Frees every park group of a linked list (not their parks).
+ *
+ * @param headGroup Pointer to the head of the group linked list.
+ */
+void freeParkGroups(ParkGroup* headGroup){
+    while (headGroup != NULL){
+        ParkGroup* next = headGroup->next;
+        free(headGroup->name);
+        free(headGroup);
+        headGroup = next;
+    }
+}
+
+
+/**
+ * @brief Finds a park group by its name.
+ *
+ * @param headGroup Pointer to the head of the group linked list.
+ * @param name The name of the group.
+ * @return Pointer to the group, or NULL if there's no such group.
+ */
+ParkGroup* getParkGroup(ParkGroup* headGroup, const char* name){
+    for (; headGroup != NULL; headGroup = headGroup->next){
+        if (strcmp(headGroup->name, name) == 0){
+            return headGroup;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief Adds a park to a group, adding the park's totals to the group's.
+ *
+ * @param group Pointer to the group.
+ * @param park Pointer to the park.
+ * @return 1 if the park was added, 0 if it was already in the group.
+ */
+int addParkToGroup(ParkGroup* group, Park* park){
+    for (unsigned int i = 0; i < park->numGroups; i++){
+        if (park->groups[i] == group){
+            return 0;
+        }
+    }
+
+    park->groups = (ParkGroup**)realloc(park->groups,
+                    (park->numGroups + 1) * sizeof(ParkGroup*));
+    park->groups[park->numGroups++] = group;
+
+    group->numParks++;
+    group->capacity += *getCapacity(park);
+    group->occupied += *getCapacity(park) - *getAvailableSpots(park);
+    group->revenue += park->revenue;
+    return 1;
+}
+
+
+/**
+ * @brief Takes a park's totals out of its groups, before it is removed.
+ *
+ * @param park Pointer to the park.
+ */
+void leaveParkGroups(Park* park){
+    for (unsigned int i = 0; i < park->numGroups; i++){
+        ParkGroup* group = park->groups[i];
+        group->numParks--;
+        group->capacity -= *getCapacity(park);
+        group->occupied -= *getCapacity(park) - *getAvailableSpots(park);
+        group->revenue -= park->revenue;
+        if (group->revenue < 0){ // only rounding errors are left
+            group->revenue = 0;
+        }
+    }
+}
+
+
+/**
+ * @brief Updates the totals of a park and of its groups after an
+ * entry/exit.
+ *
+ * @param park Pointer to the park.
+ * @param entry 1 for an entry, 0 for an exit.
+ * @param cost The cost of the stay, for an exit.
+ */
+void recordGroupEntryExit(Park* park, int entry, double cost){
+    int delta = entry ? 1 : -1;
+
+    if (!entry){
+        park->revenue += cost;
+    }
+    for (unsigned int i = 0; i < park->numGroups; i++){
+        park->groups[i]->occupied += delta;
+        if (!entry){
+            park->groups[i]->revenue += cost;
+        }
+    }
+}
+
+
+/**
+ * @brief Updates the totals of a park and of its groups after one of its
+ * visits is corrected.
+ *
+ * @param park Pointer to the park.
+ * @param freedSpot 1 if the vehicle of the visit was still inside, 0
+ * otherwise.
+ * @param revenueDelta The change in the revenue of the park.
+ */
+void recordGroupCorrection(Park* park, int freedSpot, double revenueDelta){
+    park->revenue += revenueDelta;
+    if (park->revenue < 0){ // only rounding errors are left
+        park->revenue = 0;
+    }
+    for (unsigned int i = 0; i < park->numGroups; i++){
+        ParkGroup* group = park->groups[i];
+        group->occupied -= freedSpot;
+        group->revenue += revenueDelta;
+        if (group->revenue < 0){
+            group->revenue = 0;
+        }
+    }
+}
+
+
+/**
+ * @brief Prints a group's name, number of parks, capacity, available spots
+ * and revenue.
+ *
+ * @param group Pointer to the group.
+ */
+void printParkGroup(const ParkGroup* group){
+    printf("%s %u %d %d %.2f\n", group->name, group->numParks,
+            group->capacity, group->capacity - group->occupied,
+            group->revenue);
+}
+
+
+/**
+ * @brief Prints every group, by order of creation.
+ *
+ * @param headGroup Pointer to the head of the group linked list.
+ */
+void printParkGroups(const ParkGroup* headGroup){
+    for (; headGroup != NULL; headGroup = headGroup->next){
+        printParkGroup(headGroup);
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ * Definition of the park group struct, and of the function prototypes
+ * related to it.
+ *
+ * Park groups (districts, operators, ...) gather parks under a name. Each
+ * group keeps the totals of its parks (capacity, occupied spots and the
+ * revenue of their exits), updated on every entry/exit, correction and
+ * park removal, so a group's summary doesn't visit its parks. A park may
+ * belong to many groups.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef GROUP_H
+#define GROUP_H
+
+#include "park.h"
+
+typedef struct parkGroup {
+    char* name; // name of the group
+    unsigned int numParks;
+    int capacity; // capacity of all its parks
+    int occupied; // spots occupied in all its parks
+    double revenue; // billed by its parks, by the exits so far
+    struct parkGroup* next;
+} ParkGroup;
+
+
+// Initializer
+ParkGroup* newParkGroup(char* name);
+
+// Free
+void freeParkGroups(ParkGroup* headGroup);
+
+// Getters
+ParkGroup* getParkGroup(ParkGroup* headGroup, const char* name);
+
+// Membership
+int addParkToGroup(ParkGroup* group, Park* park);
+void leaveParkGroups(Park* park);
+
+// Updates
+void recordGroupEntryExit(Park* park, int entry, double cost);
+void recordGroupCorrection(Park* park, int freedSpot, double revenueDelta);
+
+// Print groups
+void printParkGroup(const ParkGroup* group);
+void printParkGroups(const ParkGroup* headGroup);
+#endif
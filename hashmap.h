@@ -0,0 +1,216 @@
+/**
+ * Definition of a generic hash map, specialized at compile time by a macro.
+ *
+ * HASHMAP_DEFINE(Map, prefix, Key, Value, hash, equal, empty) defines the
+ * struct Map, from keys of type Key to values of type Value, and its
+ * functions:
+ *
+ *   void prefix##Init(Map* map)
+ *   void prefix##Free(Map* map)
+ *   Value* prefix##Find(const Map* map, Key key)     (NULL if not found)
+ *   Value* prefix##Put(Map* map, Key key, Value value)
+ *   void prefix##Reserve(Map* map, unsigned int numEntries)
+ *   int prefix##Remove(Map* map, Key key)            (0 if not found)
+ *
+ * hash(key) gives an unsigned int hash of a key, and equal(a, b) is
+ * non-zero if two keys are the same. They are called directly, so each map
+ * is compiled for its own types, without indirect calls. empty is a key
+ * that is never mapped (NULL for pointers), marking the unused slots. Keys
+ * are stored as they are: a map of strings only keeps the pointers.
+ *
+ * Maps use open addressing with linear probing, in a power of 2 slots at
+ * most half full, Fibonacci hashing spreading any hash over the slots. A
+ * removal shifts the following entries back, so there are no tombstones.
+ * The entries can be visited by walking the slots whose key isn't empty.
+ * Each slot keeps its key next to its value, so a probe touches a single
+ * cache line.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stdlib.h>
+#include <string.h>
+
+// Initial number of slots of a map (a power of 2)
+#define HASHMAP_INITIAL_SLOTS 16
+// log2 of HASHMAP_INITIAL_SLOTS
+#define HASHMAP_INITIAL_BITS 4
+// Multiplier for Fibonacci hashing (2^32 divided by the golden ratio)
+#define HASHMAP_FIBONACCI 2654435769u
+// Offset basis and prime of the 32-bit FNV-1a hash of strings
+#define HASHMAP_FNV_OFFSET 2166136261u
+#define HASHMAP_FNV_PRIME 16777619u
+
+
+/**
+ * @brief Hashes an unsigned int key (Fibonacci hashing mixes it later).
+ *
+ * @param key The key.
+ * @return The hash of the key.
+ */
+static inline unsigned int hashmapHashUint(unsigned int key){
+    return key;
+}
+
+
+/**
+ * @brief Compares two unsigned int keys.
+ *
+ * @param a The first key.
+ * @param b The second key.
+ * @return 1 if the keys are equal, 0 otherwise.
+ */
+static inline int hashmapEqualUint(unsigned int a, unsigned int b){
+    return a == b;
+}
+
+
+/**
+ * @brief Hashes a string key with FNV-1a.
+ *
+ * @param key The string.
+ * @return The hash of the string.
+ */
+static inline unsigned int hashmapHashString(const char* key){
+    unsigned int hash = HASHMAP_FNV_OFFSET;
+
+    for (; *key != '\0'; key++){
+        hash = (hash ^ (unsigned char)*key) * HASHMAP_FNV_PRIME;
+    }
+    return hash;
+}
+
+
+/**
+ * @brief Compares two string keys.
+ *
+ * @param a The first string.
+ * @param b The second string.
+ * @return 1 if the strings are equal, 0 otherwise.
+ */
+static inline int hashmapEqualString(const char* a, const char* b){
+    return strcmp(a, b) == 0;
+}
+
+
+// Defines the struct Map and its functions (see the top of this file)
+#define HASHMAP_DEFINE(Map, prefix, Key, Value, hash, equal, empty)          \
+typedef struct Map##Slot {                                                   \
+    Key key;                                                                 \
+    Value value;                                                             \
+} Map##Slot;                                                                 \
+                                                                             \
+typedef struct Map {                                                         \
+    Map##Slot* slots; /* unused if their key is empty */                     \
+    unsigned int numSlots; /* always a power of 2 */                         \
+    unsigned int shift; /* 32 - log2(numSlots), for Fibonacci hashing */     \
+    unsigned int numEntries;                                                 \
+} Map;                                                                       \
+                                                                             \
+/** @brief Allocates the slots of a map, all of them unused. */              \
+static inline void prefix##Allocate(Map* map, unsigned int numSlots,         \
+unsigned int shift){                                                         \
+    map->slots = (Map##Slot*)malloc(numSlots * sizeof(Map##Slot));           \
+    for (unsigned int i = 0; i < numSlots; i++){                             \
+        map->slots[i].key = empty;                                           \
+    }                                                                        \
+    map->numSlots = numSlots;                                                \
+    map->shift = shift;                                                      \
+}                                                                            \
+                                                                             \
+/** @brief Initializes an empty map. */                                      \
+static inline void prefix##Init(Map* map){                                   \
+    prefix##Allocate(map, HASHMAP_INITIAL_SLOTS,                             \
+                        32 - HASHMAP_INITIAL_BITS);                          \
+    map->numEntries = 0;                                                     \
+}                                                                            \
+                                                                             \
+/** @brief Frees the slots of a map (not what its keys point to). */         \
+static inline void prefix##Free(Map* map){                                   \
+    free(map->slots);                                                        \
+}                                                                            \
+                                                                             \
+/** @brief Calculates the slot where a key starts probing. */                \
+static inline unsigned int prefix##Home(const Map* map, Key key){            \
+    return ((unsigned int)hash(key) * HASHMAP_FIBONACCI) >> map->shift;      \
+}                                                                            \
+                                                                             \
+/** @brief Finds the slot of a key, or the unused slot to insert it. */      \
+static inline Map##Slot* prefix##Probe(const Map* map, Key key){             \
+    unsigned int index = prefix##Home(map, key);                             \
+                                                                             \
+    while (map->slots[index].key != empty &&                                 \
+            !equal(map->slots[index].key, key)){                             \
+        index = (index + 1) & (map->numSlots - 1);                           \
+    }                                                                        \
+    return &map->slots[index];                                               \
+}                                                                            \
+                                                                             \
+/** @brief Finds the value of a key, or NULL if the key isn't mapped. */     \
+static inline Value* prefix##Find(const Map* map, Key key){                  \
+    Map##Slot* slot = prefix##Probe(map, key);                               \
+                                                                             \
+    return slot->key != empty ? &slot->value : NULL;                         \
+}                                                                            \
+                                                                             \
+/** @brief Doubles the slots of a map, placing every entry again. */         \
+static inline void prefix##Grow(Map* map){                                   \
+    Map old = *map;                                                          \
+                                                                             \
+    prefix##Allocate(map, old.numSlots * 2, old.shift - 1);                  \
+    for (unsigned int i = 0; i < old.numSlots; i++){                         \
+        if (old.slots[i].key != empty){                                      \
+            *prefix##Probe(map, old.slots[i].key) = old.slots[i];            \
+        }                                                                    \
+    }                                                                        \
+    prefix##Free(&old);                                                      \
+}                                                                            \
+                                                                             \
+/** @brief Grows a map to hold some entries without growing again. */        \
+static inline void prefix##Reserve(Map* map, unsigned int numEntries){       \
+    while (numEntries * 2 > map->numSlots){                                  \
+        prefix##Grow(map);                                                   \
+    }                                                                        \
+}                                                                            \
+                                                                             \
+/** @brief Maps a key to a value, replacing its old value if it had one. */  \
+static inline Value* prefix##Put(Map* map, Key key, Value value){            \
+    Map##Slot* slot = prefix##Probe(map, key);                               \
+                                                                             \
+    if (slot->key == empty){                                                 \
+        if ((map->numEntries + 1) * 2 > map->numSlots){                      \
+            prefix##Grow(map);                                               \
+            slot = prefix##Probe(map, key);                                  \
+        }                                                                    \
+        slot->key = key;                                                     \
+        map->numEntries++;                                                   \
+    }                                                                        \
+    slot->value = value;                                                     \
+    return &slot->value;                                                     \
+}                                                                            \
+                                                                             \
+/** @brief Removes a key, shifting back the entries probed after it. */      \
+static inline int prefix##Remove(Map* map, Key key){                         \
+    unsigned int mask = map->numSlots - 1;                                   \
+    unsigned int hole = prefix##Probe(map, key) - map->slots;                \
+                                                                             \
+    if (map->slots[hole].key == empty){                                      \
+        return 0;                                                            \
+    }                                                                        \
+    for (unsigned int next = (hole + 1) & mask;                              \
+            map->slots[next].key != empty; next = (next + 1) & mask){        \
+        /* An entry moves back if the hole is between its home and it */     \
+        unsigned int home = prefix##Home(map, map->slots[next].key);         \
+        if (((next - home) & mask) >= ((next - hole) & mask)){               \
+            map->slots[hole] = map->slots[next];                             \
+            hole = next;                                                     \
+        }                                                                    \
+    }                                                                        \
+    map->slots[hole].key = empty;                                            \
+    map->numEntries--;                                                       \
+    return 1;                                                                \
+}
+
+#endif
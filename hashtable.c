@@ -57,6 +57,7 @@ Hashtable* newHashtable(){
 
     ht->size = INITIAL_SIZE;
     ht->numElements = 0;
+    ht->lastChainLength = 0;
 
     return ht;
 }
@@ -75,6 +76,28 @@ int getSize(const Hashtable* ht){
 }
 
 
+/**
+ * @brief Gets the number of logs in the hashtable.
+ * 
+ * @param ht Pointer to the hashtable.
+ * @return The number of logs.
+ */
+unsigned int getNumElements(const Hashtable* ht){
+    return ht->numElements;
+}
+
+
+/**
+ * @brief Gets the number of logs visited by the last lookup or insertion.
+ * 
+ * @param ht Pointer to the hashtable.
+ * @return The length of the chain walked.
+ */
+unsigned int getLastChainLength(const Hashtable* ht){
+    return ht->lastChainLength;
+}
+
+
 /**
  * @brief Gets the log at the specified index in the hashtable.
  * 
@@ -109,7 +132,9 @@ Log* getPlateLastLogWithoutExit(Hashtable* ht, const char plate[PLATE_LENGTH]){
     Log* currentLog = getLogAtIndex(ht, plateHash(plate, getSize(ht)));
 
     // Transverse the log linked list
+    ht->lastChainLength = 0;
     while (currentLog != NULL){
+        ht->lastChainLength++;
         // No exit means the exit timestamp is the INITIAL_TIMESTAMP
         if (strcmp(getLogPlate(currentLog), plate) == 0 &&
             isInitialTimestamp(getExitTimestamp(currentLog))){
@@ -123,18 +148,47 @@ Log* getPlateLastLogWithoutExit(Hashtable* ht, const char plate[PLATE_LENGTH]){
 
 
 /**
- * @brief Frees memory allocated for logs in the hashtable.
+ * @brief Gets the log of a plate with the given entry timestamp.
  * 
- * This function iterates through all logs in the hashtable and frees
- * the memory allocated for them.
+ * @param ht Pointer to the hashtable.
+ * @param plate The license plate to search for.
+ * @param entry Pointer to the entry timestamp of the log.
+ * @return Pointer to the log, or NULL if none is found.
+ */
+Log* getPlateLogAt(Hashtable* ht, const char plate[PLATE_LENGTH],
+const Timestamp* entry){
+    Log* currentLog = getLogAtIndex(ht, plateHash(plate, getSize(ht)));
+
+    for (ht->lastChainLength = 0; currentLog != NULL;
+            currentLog = currentLog->next){
+        ht->lastChainLength++;
+        if (strcmp(getLogPlate(currentLog), plate) == 0 &&
+            compareTimestamps(getEntryTimestamp(currentLog), entry) == 0){
+            return currentLog;
+        }
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief Checks if the hashtable has any log of a plate.
  * 
  * @param ht Pointer to the hashtable.
+ * @param plate The license plate to search for.
+ * @return 1 if there's a log of the plate, 0 otherwise.
  */
-void freeHashtableLogs(Hashtable* ht){
-    for (unsigned int i = 0; i < ht->size; i++){
-        freeLog(getLogAtIndex(ht, i));
+int plateHasLogs(Hashtable* ht, const char plate[PLATE_LENGTH]){
+    Log* currentLog = getLogAtIndex(ht, plateHash(plate, getSize(ht)));
+
+    for (ht->lastChainLength = 0; currentLog != NULL;
+            currentLog = currentLog->next){
+        ht->lastChainLength++;
+        if (strcmp(getLogPlate(currentLog), plate) == 0){
+            return 1;
+        }
     }
-    free(ht->logs);
+    return 0;
 }
 
 
@@ -221,12 +275,13 @@ void resizeHashtable(Hashtable** ht){
 /**
  * @brief Frees memory allocated for the hashtable.
  * 
- * This function frees the memory allocated for the hashtable and all its logs.
+ * This function frees the memory allocated for the hashtable, but not its
+ * logs: they belong to the log pool of the park.
  * 
  * @param ht Pointer to the hashtable.
  */
 void freeHashtable(Hashtable* ht){
-    freeHashtableLogs(ht);
+    free(ht->logs);
     free(ht);
 }
 
@@ -240,14 +295,18 @@ void freeHashtable(Hashtable* ht){
  * 
  * @param ht Pointer to the hashtable.
  * @param log Pointer to the log to add.
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
  */
-void addLogToTable(Hashtable* ht, Log* log){
+void addLogToTable(Hashtable* ht, Log* log, Tracer* tracer){
     (ht->numElements)++;
 
+    SpanStart start = traceBegin(tracer);
     unsigned int index = plateHash(getLogPlate(log), getSize(ht));
     Log* currentLog = getLogAtIndex(ht, index);
+    traceEnd(tracer, "hash probe", &start);
 
     // If there are no logs at the index, make log the head of the linked list
+    ht->lastChainLength = 0;
     if (currentLog == NULL){
         ht->logs[index] = log;
         // Resizing is not needed if log was inserted as head of a linked list,
@@ -256,13 +315,38 @@ void addLogToTable(Hashtable* ht, Log* log){
     }
     
     // Search for the end of the linked list
-    while (currentLog->next != NULL){
+    start = traceBegin(tracer);
+    for (ht->lastChainLength = 1; currentLog->next != NULL;
+            ht->lastChainLength++){
         currentLog = currentLog->next;
     }
     currentLog->next = log; // Add it to the end
+    traceEnd(tracer, "chain walk", &start);
 
     // Check if the hashtable needs resizing, and if so do it.
     if ((double)ht->numElements / getSize(ht) > LOAD_FACTOR_THRESHOLD){
+        start = traceBegin(tracer);
         resizeHashtable(&ht);
+        traceEnd(tracer, "resizeHashtable", &start);
     }
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Removes a log from the hashtable (the log itself is not freed).
+ * 
+ * @param ht Pointer to the hashtable.
+ * @param log Pointer to the log to remove.
+ */
+void removeLogFromTable(Hashtable* ht, Log* log){
+    Log** link = &ht->logs[plateHash(getLogPlate(log), getSize(ht))];
+
+    while (*link != NULL && *link != log){
+        link = &(*link)->next;
+    }
+    if (*link != NULL){
+        *link = log->next;
+        log->next = NULL;
+        (ht->numElements)--;
+    }
+}
@@ -10,6 +10,7 @@
 #define HASHTABLE_H
 
 #include "log.h"
+#include "trace.h"
 
 // Initial size of the hashtable
 #define INITIAL_SIZE 53
@@ -21,6 +22,7 @@ typedef struct Hashtable {
     Log** logs;
     unsigned int size;
     unsigned int numElements;
+    unsigned int lastChainLength; // logs visited by the last lookup/insert
 } Hashtable;
 
 
@@ -32,8 +34,13 @@ Hashtable* newHashtable();
 
 // Getters
 int getSize(const Hashtable* ht);
+unsigned int getNumElements(const Hashtable* ht);
+unsigned int getLastChainLength(const Hashtable* ht);
 Log* getLogAtIndex(Hashtable* ht, unsigned int index);
 Log* getPlateLastLogWithoutExit(Hashtable* ht, const char plate[PLATE_LENGTH]);
+Log* getPlateLogAt(Hashtable* ht, const char plate[PLATE_LENGTH],
+                    const Timestamp* entry);
+int plateHasLogs(Hashtable* ht, const char plate[PLATE_LENGTH]);
 
 // Resizing
 void resizeHashtable(Hashtable** ht);
@@ -41,5 +48,6 @@ void resizeHashtable(Hashtable** ht);
 // Freeing
 void freeHashtable(Hashtable* Hashtable);
 
-void addLogToTable(Hashtable* Hashtable, Log* log);
+void addLogToTable(Hashtable* Hashtable, Log* log, Tracer* tracer);
+void removeLogFromTable(Hashtable* ht, Log* log);
 #endif
\ No newline at end of file
@@ -0,0 +1,148 @@
+/**
+ * Implementation of the functions related to HyperLogLog sketches.
+ *
+ * A HyperLogLog sketch estimates how many distinct values were added to it
+ * using a fixed amount of memory.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <string.h>
+#include "hyperloglog.h"
+
+// Constants of the splitmix64 finalizer
+#define SPLITMIX_GAMMA 0x9E3779B97F4A7C15ULL
+#define SPLITMIX_MUL1 0xBF58476D1CE4E5B9ULL
+#define SPLITMIX_MUL2 0x94D049BB133111EBULL
+// Bias correction constants of the estimator
+#define HLL_ALPHA 0.7213
+#define HLL_ALPHA_CORRECTION 1.079
+// Below HLL_SMALL_RANGE * HLL_REGISTERS linear counting is more precise
+#define HLL_SMALL_RANGE 2.5
+// Natural logarithm of 2
+#define LN_2 0.69314718055994530942
+// Number of terms of the series used to compute logarithms
+#define LOG_SERIES_TERMS 30
+
+
+/**
+ * @brief Initializes an empty sketch.
+ *
+ * @param hll Pointer to the sketch.
+ */
+void initHyperLogLog(HyperLogLog* hll){
+    memset(hll->registers, 0, sizeof(hll->registers));
+}
+
+
+/**
+ * @brief Hashes a 32-bit value into 64 well mixed bits.
+ *
+ * Uses the splitmix64 finalizer, so consecutive values (such as packed
+ * plates) produce unrelated hashes.
+ *
+ * @param value The value to hash.
+ * @return The 64-bit hash.
+ */
+unsigned long long hllHash(unsigned int value){
+    unsigned long long z = value + SPLITMIX_GAMMA;
+
+    z = (z ^ (z >> 30)) * SPLITMIX_MUL1;
+    z = (z ^ (z >> 27)) * SPLITMIX_MUL2;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * @brief Adds a hashed value to a sketch.
+ *
+ * The first HLL_PRECISION bits choose the register, which keeps the
+ * highest position of the first set bit in the remaining bits.
+ *
+ * @param hll Pointer to the sketch.
+ * @param hash The 64-bit hash of the value.
+ */
+void hllAdd(HyperLogLog* hll, unsigned long long hash){
+    unsigned int index = (unsigned int)(hash >> (64 - HLL_PRECISION));
+    // Guarantee a set bit so the count of leading zeros is defined
+    unsigned long long rest = (hash << HLL_PRECISION) |
+                                (1ULL << (HLL_PRECISION - 1));
+    unsigned char rank = (unsigned char)(__builtin_clzll(rest) + 1);
+
+    if (rank > hll->registers[index]){
+        hll->registers[index] = rank;
+    }
+}
+
+
+/**
+ * @brief Merges a sketch into another, which then estimates the distinct
+ * values added to either of them.
+ *
+ * @param dest Pointer to the sketch receiving the merge.
+ * @param source Pointer to the sketch to merge.
+ */
+void hllMerge(HyperLogLog* dest, const HyperLogLog* source){
+    for (int i = 0; i < HLL_REGISTERS; i++){
+        if (source->registers[i] > dest->registers[i]){
+            dest->registers[i] = source->registers[i];
+        }
+    }
+}
+
+
+/**
+ * @brief Calculates the natural logarithm of a positive number.
+ *
+ * Brings x into [1, 2) by powers of 2 and then uses the series
+ * ln(x) = 2 * (y + y^3/3 + y^5/5 + ...), with y = (x - 1) / (x + 1).
+ *
+ * @param x The number (must be positive).
+ * @return The natural logarithm of x.
+ */
+double naturalLog(double x){
+    int exponent = 0;
+
+    while (x >= 2){
+        x /= 2;
+        exponent++;
+    }
+    while (x < 1){
+        x *= 2;
+        exponent--;
+    }
+
+    double y = (x - 1) / (x + 1), y2 = y * y, term = y, sum = 0;
+    for (int i = 0; i < LOG_SERIES_TERMS; i++){
+        sum += term / (2 * i + 1);
+        term *= y2;
+    }
+
+    return exponent * LN_2 + 2 * sum;
+}
+
+
+/**
+ * @brief Estimates the number of distinct values added to a sketch.
+ *
+ * @param hll Pointer to the sketch.
+ * @return The estimated number of distinct values.
+ */
+double hllEstimate(const HyperLogLog* hll){
+    double m = HLL_REGISTERS;
+    double sum = 0;
+    int zeros = 0;
+
+    for (int i = 0; i < HLL_REGISTERS; i++){
+        sum += 1.0 / (double)(1ULL << hll->registers[i]);
+        zeros += (hll->registers[i] == 0);
+    }
+
+    double alpha = HLL_ALPHA / (1 + HLL_ALPHA_CORRECTION / m);
+    double estimate = alpha * m * m / sum;
+
+    // Few distinct values: linear counting on the empty registers
+    if (estimate <= HLL_SMALL_RANGE * m && zeros > 0){
+        estimate = m * naturalLog(m / zeros);
+    }
+    return estimate;
+}
@@ -0,0 +1,37 @@
+/**
+ * Definition of the HyperLogLog struct, and of the related function
+ * prototypes.
+ *
+ * A HyperLogLog sketch estimates how many distinct values were added to it
+ * using a fixed amount of memory (HLL_REGISTERS bytes). Sketches can be
+ * merged to estimate the distinct values of their union.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef HYPERLOGLOG_H
+#define HYPERLOGLOG_H
+
+// Number of hash bits used to choose a register
+#define HLL_PRECISION 12
+// Number of registers of each sketch (2^HLL_PRECISION)
+#define HLL_REGISTERS (1 << HLL_PRECISION)
+
+typedef struct hyperLogLog {
+    // Highest position of the first set bit seen in each register's hashes
+    unsigned char registers[HLL_REGISTERS];
+} HyperLogLog;
+
+
+// Initializer
+void initHyperLogLog(HyperLogLog* hll);
+
+// Hashing function
+unsigned long long hllHash(unsigned int value);
+
+// Updates
+void hllAdd(HyperLogLog* hll, unsigned long long hash);
+void hllMerge(HyperLogLog* dest, const HyperLogLog* source);
+
+// Estimation
+double hllEstimate(const HyperLogLog* hll);
+#endif
@@ -32,12 +32,62 @@ Log *newLog(const char plate[PLATE_LENGTH], char *parkName){
     newLogNode->parkName = parkName;
     newLogNode->entryTimestamp = INITIAL_TIMESTAMP;
     newLogNode->exitTimestamp = INITIAL_TIMESTAMP;
+    newLogNode->cost = 0;
     newLogNode->next = NULL;
+    newLogNode->exitNode = 0;
+    newLogNode->prevVisit = NULL;
+    newLogNode->nextVisit = NULL;
 
     return newLogNode;
 }
 
 
+/**
+ * @brief Initializes an empty log pool.
+ * 
+ * @param pool Pointer to the log pool.
+ */
+void initLogPool(LogPool* pool){
+    pool->slabs = NULL;
+    pool->used = LOG_SLAB_SIZE;
+}
+
+
+/**
+ * @brief Creates a new log, like newLog, taking it from a log pool.
+ * 
+ * Logs are allocated a slab at a time, so only one in LOG_SLAB_SIZE logs
+ * allocates memory. They can't be freed with freeLog: they live until the
+ * whole pool is freed.
+ * 
+ * @param pool Pointer to the log pool.
+ * @param plate The license plate associated with the log.
+ * @param parkName The name of the park associated with the log.
+ * @return A pointer to the new log.
+ */
+Log* poolLog(LogPool* pool, const char plate[PLATE_LENGTH], char* parkName){
+    if (pool->used == LOG_SLAB_SIZE){
+        LogSlab* slab = (LogSlab*)malloc(sizeof(LogSlab));
+        slab->next = pool->slabs;
+        pool->slabs = slab;
+        pool->used = 0;
+    }
+
+    Log* log = &pool->slabs->logs[pool->used++];
+    strcpy(log->plate, plate);
+    log->parkName = parkName;
+    log->entryTimestamp = INITIAL_TIMESTAMP;
+    log->exitTimestamp = INITIAL_TIMESTAMP;
+    log->cost = 0;
+    log->next = NULL;
+    log->exitNode = 0;
+    log->prevVisit = NULL;
+    log->nextVisit = NULL;
+
+    return log;
+}
+
+
 /**
  * @brief Copies the entry and exit timestamps from the source log to the
  * destination log.
@@ -71,6 +121,22 @@ void freeLog(Log *log){
 }
 
 
+/**
+ * @brief Frees the slabs of a log pool, and so every log taken from it.
+ * 
+ * @param pool Pointer to the log pool.
+ */
+void freeLogPool(LogPool* pool){
+    LogSlab* slab = pool->slabs;
+    while (slab != NULL){
+        LogSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    initLogPool(pool);
+}
+
+
 /**
  * @brief Retrieves the name of the park associated with a log entry.
  * 
@@ -115,6 +181,15 @@ Timestamp* getExitTimestamp(Log *log){
 }
 
 
+/**
+ * @brief Retrieves the cost billed at the exit of a log entry.
+ * 
+ * @param log The log entry.
+ * @return The cost of the stay, or 0 if the vehicle is still inside.
+ */
+double getLogCost(const Log* log){
+    return log->cost;
+}
 
 
 /**
@@ -133,111 +208,6 @@ Log *findLastLog(Log *log){
 }
 
 
-/**
- * @brief Prints the log entries.
- * 
- * This function prints the log entries, including the park name, entry
- * timestamp and exit timestamp (if available).
- * 
- * @param log The head of the log linked list.
- */
-void printLog(Log *log){
-    Timestamp* exitTimestamp;
-    Timestamp* entryTimestamp;
-
-    while (log != NULL){
-        exitTimestamp = getExitTimestamp(log);
-        entryTimestamp = getEntryTimestamp(log);
-
-        // Print the entry timestamp
-        printf("%s ", getLogParkName(log));
-        printTimestamp(entryTimestamp);
-
-        // If an exit exists, print its timestamp
-        if (!isInitialTimestamp(exitTimestamp)){
-            printf(" ");
-            printTimestamp(exitTimestamp);
-        }
-        printf("\n");
-        log = log->next;
-    }
-}
-
-
-/**
- * @brief Prints the daily bill for each entry in the log.
- * 
- * This function prints the daily bill for each entry in the log linked list.
- * It calculates the parking cost based on the given tariff and prints the
- * plate, exit time, and corresponding cost.
- * 
- * @param log The head of the log linked list.
- * @param tariff Pointer to the tariff structure containing parking rates.
- */
-void printDailyBillLog(Log *log, Tariff *tariff){
-    while (log != NULL){
-        Timestamp* exitTimestamp = getExitTimestamp(log);
-
-        printPlate(getLogPlate(log));
-        printf(" ");
-        printHourMinutes(exitTimestamp);
-        printf(" ");
-        printf("%.2f\n",
-        calculateParkingCost(tariff, getEntryTimestamp(log), exitTimestamp));
-        log = log->next;
-    }
-}
-
-
-/**
- * @brief Prints the full bill for each day in the log.
- * 
- * This function prints the full bill for each day in the log linked list.
- * It calculates the total parking cost for each day based on the given tariff
- * and prints the date and corresponding total cost.
- * 
- * @param log The head of the log linked list.
- * @param tariff Pointer to the tariff structure containing parking rates.
- */
-void printFullBillLog(Log *log, Tariff *tariff){
-    double bill = 0;
-    Timestamp* currentTimestamp;
-    Timestamp* exitTimestamp;
-    int printLastBill = 0; // Used to know if there were any bills
-
-    if (log != NULL){
-        printLastBill = 1;
-        exitTimestamp = getExitTimestamp(log);
-        currentTimestamp = getExitTimestamp(log);
-    }
-
-    while (log != NULL){
-        exitTimestamp = getExitTimestamp(log);
-
-        // Check if the exit date has changed
-        if (compareDate(currentTimestamp, exitTimestamp) != 0){
-            // If it did, print the bill for the previous day
-            printDate(currentTimestamp);
-            printf(" %.2f\n", bill);
-            copyTimestamp(currentTimestamp, exitTimestamp);
-            bill = 0;
-        }
-
-        // Build up the bill for the current exit date
-        bill += calculateParkingCost(tariff, getEntryTimestamp(log),
-                                        exitTimestamp);
-
-        log = log->next;
-    }
-
-    // Print last bill, which can't be printed inside while loop
-    if (printLastBill){
-        printDate(currentTimestamp);
-        printf(" %.2f\n", bill);
-    }
-}
-
-
 /**
  * @brief Merges two sorted linked lists of logs based on a specified sorting
  * criteria.
@@ -314,33 +284,65 @@ void split(Log *head, Log **firstHalf, Log **secondHalf){
 }
 
 
+/**
+ * @brief Sorts a linked list of logs of known length, sorting the two
+ * halves in parallel when the list is long enough.
+ * 
+ * @param sortJob Pointer to the SortJob with the list to sort.
+ */
+void sortLogs(void* sortJob){
+    SortJob* job = (SortJob*)sortJob;
+    Log *firstHalf;
+    Log *secondHalf;
+
+    if (job->length < 2){
+        return;
+    }
+
+    split(*job->head, &firstHalf, &secondHalf);
+
+    // split gives the first half the middle log of odd lengths
+    SortJob first = {&firstHalf, job->sortBy, (job->length + 1) / 2,
+                        job->scheduler};
+    SortJob second = {&secondHalf, job->sortBy, job->length / 2,
+                        job->scheduler};
+    if (job->length >= PARALLEL_SORT_MIN_LENGTH){
+        forkJoin(job->scheduler, sortLogs, &first, sortLogs, &second);
+    }
+    else {
+        sortLogs(&first);
+        sortLogs(&second);
+    }
+
+    *job->head = merge(firstHalf, secondHalf, job->sortBy);
+}
+
+
 /**
  * @brief Sorts a linked list of logs using merge sort algorithm.
  * 
  * This function sorts a linked list of logs based on a specified sorting
  * criteria.
  * The sorting criteria can be either by entry timestamp ('e') or exit
- * timestamp (any other char).
+ * timestamp (any other char). Long lists are sorted in parallel, with the
+ * same result.
  * 
  * @param head Pointer to the head of the linked list to be sorted.
  * @param sortBy Sorting criteria: 'e' for entry timestamp, any other char
  * for exit timestamp.
+ * @param scheduler Pointer to the scheduler running the sort.
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
  */
-void mergeSort(Log **head, const char sortBy){
-    Log *tempHead = *head;
-    Log *firstHalf;
-    Log *secondHalf;
+void mergeSort(Log **head, const char sortBy, Scheduler* scheduler,
+Tracer* tracer){
+    SortJob job = {head, sortBy, 0, scheduler};
+    SpanStart start = traceBegin(tracer);
 
-    if (tempHead == NULL || tempHead->next == NULL){
-        return;
+    for (Log* log = *head; log != NULL; log = log->next){
+        job.length++;
     }
-
-    split(tempHead, &firstHalf, &secondHalf);
-
-    mergeSort(&firstHalf, sortBy);
-    mergeSort(&secondHalf, sortBy);
-
-    *head = merge(firstHalf, secondHalf, sortBy);
+    sortLogs(&job);
+    traceEnd(tracer, "mergeSort", &start);
 }
 
 
@@ -10,38 +10,67 @@
 #define LOG_H
 
 #include "plate.h"
+#include "scheduler.h"
 #include "tariff.h"
 #include "timestamp.h"
+#include "trace.h"
+
+// Lists shorter than this are sorted by a single worker
+#define PARALLEL_SORT_MIN_LENGTH 4096
+// Number of logs allocated at once by a log pool
+#define LOG_SLAB_SIZE 1024
 
 typedef struct log{
     char plate[PLATE_LENGTH];
+    unsigned int exitNode; // node in its park's exit tree (0: no exit yet)
     char* parkName;
     Timestamp entryTimestamp; // Timestamp when the vehicle enters the park
     Timestamp exitTimestamp;  // Timestamp when the vehicle exits the park
+    double cost; // billed at the exit (0 while the vehicle is inside)
     struct log* next;
+    // Visits of the same plate, in any park, by entry (see addPlateVisit)
+    struct log* prevVisit;
+    struct log* nextVisit;
 } Log;
 
+typedef struct sortJob {
+    Log** head; // list to sort
+    char sortBy;
+    unsigned int length; // number of logs in the list
+    Scheduler* scheduler;
+} SortJob;
+
+typedef struct logSlab {
+    Log logs[LOG_SLAB_SIZE];
+    struct logSlab* next; // slab allocated before this one
+} LogSlab;
+
+typedef struct logPool {
+    LogSlab* slabs; // newest slab first
+    unsigned int used; // logs handed out from the newest slab
+} LogPool;
+
 // Initialization
 Log* newLog(const char plate[PLATE_LENGTH], char* parkName);
 void copyLogTimestamps(Log* dest, const Log* source);
+void initLogPool(LogPool* pool);
+Log* poolLog(LogPool* pool, const char plate[PLATE_LENGTH], char* parkName);
 
 // Memory freeing
 void freeLog(Log* log);
+void freeLogPool(LogPool* pool);
 
 // Getters
 char* getLogParkName(Log* log);
 char* getLogPlate(Log* log);
 Timestamp* getEntryTimestamp(Log* log);
 Timestamp* getExitTimestamp(Log* log);
+double getLogCost(const Log* log);
 Log* findLastLog(Log* log);
 
-// Display logs
-void printLog(Log* log);
-void printDailyBillLog(Log* log, Tariff* tariff);
-void printFullBillLog(Log* log, Tariff* tariff);
-
 // Sort a log
-void mergeSort(Log** head, const char sortBy);
+void mergeSort(Log** head, const char sortBy, Scheduler* scheduler,
+                Tracer* tracer);
 
 // Add a new log entry to a log linked list
 void addLogtoLog(Log** head, Log* log);
@@ -0,0 +1,591 @@
+/**
+ * Implementation of the functions related to the compressed segments.
+ *
+ * Blocks are compressed with a greedy LZ77 codec, and segment files are
+ * read back through a stdio stream, so every reader of event files gets
+ * them decompressed.
+ *
+ * Author: Adolfo Monteiro
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "lz.h"
+#include "trace.h"
+
+// Multiplier of the hash of 4 bytes (2^32 divided by the golden ratio)
+#define LZ_HASH_MULTIPLIER 2654435769u
+// Length in a token (4 bits) from which more length bytes follow
+#define LZ_LENGTH_MASK 15
+// Failed match searches that double the step over incompressible data
+#define LZ_SKIP_SHIFT 6
+// Bytes copied at a time by short matches, when there's room for them
+#define LZ_COPY_CHUNK 8
+// Bytes copied at a time by literals and matches, when there's room
+#define LZ_WILD_COPY 16
+// Block bytes after a token that hold a sequence with short lengths
+#define LZ_FAST_INPUT LZ_WILD_COPY
+// Room taken by a sequence with short lengths: its literals and match,
+// and the chunk copied past the match's end
+#define LZ_FAST_OUTPUT (2 * (LZ_LENGTH_MASK - 1) + LZ_MIN_MATCH + \
+                        LZ_COPY_CHUNK)
+
+
+/**
+ * @brief Reads 4 bytes as a little endian number.
+ *
+ * @param bytes Pointer to the bytes.
+ * @return The number.
+ */
+unsigned int readLz32(const unsigned char* bytes){
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+            ((unsigned int)bytes[3] << 24);
+}
+
+
+/**
+ * @brief Writes a number as 4 little endian bytes.
+ *
+ * @param bytes Where to write the bytes.
+ * @param value The number.
+ */
+void writeLz32(unsigned char* bytes, unsigned int value){
+    for (int i = 0; i < 4; i++){
+        bytes[i] = (unsigned char)(value >> (8 * i));
+    }
+}
+
+
+/**
+ * @brief Calculates the hash of the 4 bytes at a position.
+ *
+ * @param bytes Pointer to the bytes.
+ * @return The hash, of LZ_HASH_BITS bits.
+ */
+unsigned int hashLz32(const unsigned char* bytes){
+    return (readLz32(bytes) * LZ_HASH_MULTIPLIER) >> (32 - LZ_HASH_BITS);
+}
+
+
+/**
+ * @brief Writes the bytes that extend a length that didn't fit its token.
+ *
+ * @param out Where to write the bytes.
+ * @param length The length minus LZ_LENGTH_MASK.
+ * @return Pointer to after the bytes written.
+ */
+unsigned char* writeLzLength(unsigned char* out, size_t length){
+    for (; length >= 255; length -= 255){
+        *out++ = 255;
+    }
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+
+/**
+ * @brief Writes a sequence: its token, its literals and its match.
+ *
+ * @param out Where to write the sequence.
+ * @param literals Pointer to the literals.
+ * @param numLiterals Number of literals.
+ * @param offset Distance back of the match (0: no match, last sequence).
+ * @param matchLength Length of the match.
+ * @return Pointer to after the sequence.
+ */
+unsigned char* writeLzSequence(unsigned char* out,
+const unsigned char* literals, size_t numLiterals, size_t offset,
+size_t matchLength){
+    unsigned char* token = out++;
+    size_t matchCode = offset > 0 ? matchLength - LZ_MIN_MATCH : 0;
+
+    *token = (unsigned char)(
+        (numLiterals < LZ_LENGTH_MASK ? numLiterals : LZ_LENGTH_MASK) << 4 |
+        (matchCode < LZ_LENGTH_MASK ? matchCode : LZ_LENGTH_MASK));
+    if (numLiterals >= LZ_LENGTH_MASK){
+        out = writeLzLength(out, numLiterals - LZ_LENGTH_MASK);
+    }
+    memcpy(out, literals, numLiterals);
+    out += numLiterals;
+    if (offset == 0){
+        return out;
+    }
+
+    *out++ = (unsigned char)offset;
+    *out++ = (unsigned char)(offset >> 8);
+    if (matchCode >= LZ_LENGTH_MASK){
+        out = writeLzLength(out, matchCode - LZ_LENGTH_MASK);
+    }
+    return out;
+}
+
+
+/**
+ * @brief Compresses a block.
+ *
+ * @param source The bytes to compress.
+ * @param length Number of bytes (at most LZ_BLOCK_SIZE).
+ * @param destination Where to write the compressed block, with room for
+ * LZ_BOUND(length) bytes.
+ * @return Length of the compressed block.
+ */
+size_t lzCompress(const unsigned char* source, size_t length,
+unsigned char* destination){
+    unsigned int table[1 << LZ_HASH_BITS] = {0}; // last position of a hash
+    unsigned char* out = destination;
+    size_t anchor = 0; // first byte not written yet
+    // Matches end before the last literals, so 4 bytes can always be read
+    size_t limit = length > LZ_LAST_LITERALS + LZ_MIN_MATCH ?
+                    length - LZ_LAST_LITERALS : 0;
+    size_t i = 0;
+
+    while (i + LZ_MIN_MATCH <= limit){
+        unsigned int hash = hashLz32(source + i);
+        size_t candidate = table[hash];
+        table[hash] = (unsigned int)i;
+
+        if (candidate >= i || i - candidate > LZ_MAX_OFFSET ||
+            readLz32(source + candidate) != readLz32(source + i)){
+            // Bigger steps the longer no match is found
+            i += 1 + ((i - anchor) >> LZ_SKIP_SHIFT);
+            continue;
+        }
+
+        // Extend the match backwards over the literals, then forwards
+        while (i > anchor && candidate > 0 &&
+                source[i - 1] == source[candidate - 1]){
+            i--;
+            candidate--;
+        }
+        size_t matchLength = LZ_MIN_MATCH;
+        while (i + matchLength < limit &&
+                source[candidate + matchLength] == source[i + matchLength]){
+            matchLength++;
+        }
+
+        out = writeLzSequence(out, source + anchor, i - anchor,
+                                i - candidate, matchLength);
+        i += matchLength;
+        anchor = i;
+        // The bytes just matched are likely to repeat
+        if (i + LZ_MIN_MATCH <= limit){
+            table[hashLz32(source + i - 2)] = (unsigned int)(i - 2);
+        }
+    }
+
+    return writeLzSequence(out, source + anchor, length - anchor, 0, 0) -
+            destination;
+}
+
+
+/**
+ * @brief Reads the bytes that extend a length that didn't fit its token.
+ *
+ * @param in Pointer to the position in the block, advanced.
+ * @param end End of the block.
+ * @param length The length to extend.
+ * @return 1 if the bytes were read, 0 if the block ends before them.
+ */
+int readLzLength(const unsigned char** in, const unsigned char* end,
+size_t* length){
+    unsigned char byte;
+
+    do {
+        if (*in == end){
+            return 0;
+        }
+        byte = *(*in)++;
+        *length += byte;
+    } while (byte == 255);
+    return 1;
+}
+
+
+/**
+ * @brief Copies a match whose destination has room for LZ_WILD_COPY bytes
+ * past its end, which later copies overwrite.
+ *
+ * A run shorter than LZ_COPY_CHUNK is first repeated until it's as long,
+ * a run also repeating at twice its length, so every chunk is written
+ * before being read.
+ *
+ * @param out Where to write the match.
+ * @param offset Distance back of the match (1 to the bytes already written).
+ * @param matchLength Length of the match.
+ */
+void copyLzMatch(unsigned char* out, size_t offset, size_t matchLength){
+    const unsigned char* from = out - offset;
+    unsigned char* matchEnd = out + matchLength;
+
+    for (; offset < LZ_COPY_CHUNK; offset *= 2){
+        memcpy(out, from, offset);
+        out += offset;
+    }
+    from = out - offset;
+    if (offset >= LZ_WILD_COPY){
+        for (; out < matchEnd; out += LZ_WILD_COPY, from += LZ_WILD_COPY){
+            memcpy(out, from, LZ_WILD_COPY);
+        }
+        return;
+    }
+    for (; out < matchEnd; out += LZ_COPY_CHUNK, from += LZ_COPY_CHUNK){
+        memcpy(out, from, LZ_COPY_CHUNK);
+    }
+}
+
+
+/**
+ * @brief Decompresses a block.
+ *
+ * Literals and matches are copied LZ_WILD_COPY bytes at a time while the
+ * block and destination have room for the bytes past their end, which
+ * later copies overwrite. Only the end of a block is copied exactly.
+ *
+ * Most sequences have both lengths in their token: while there's room for
+ * the longest of them (LZ_FAST_INPUT and LZ_FAST_OUTPUT), they're copied
+ * with fixed-length copies, checking only their offset.
+ *
+ * @param source The compressed block.
+ * @param length Length of the compressed block.
+ * @param destination Where to write the decompressed bytes.
+ * @param capacity Room in destination.
+ * @return Number of bytes decompressed, or -1 if the block is corrupt.
+ */
+long lzDecompress(const unsigned char* source, size_t length,
+unsigned char* destination, size_t capacity){
+    const unsigned char* in = source;
+    const unsigned char* end = source + length;
+    unsigned char* out = destination;
+    unsigned char* outEnd = destination + capacity;
+
+    while (in < end){
+        unsigned int token = *in++;
+        size_t numLiterals = token >> 4;
+        size_t matchLength = token & LZ_LENGTH_MASK;
+
+        if (numLiterals < LZ_LENGTH_MASK && matchLength < LZ_LENGTH_MASK &&
+            end - in >= LZ_FAST_INPUT && outEnd - out >= LZ_FAST_OUTPUT){
+            // The offset follows the literals, before the end of the block
+            memcpy(out, in, LZ_WILD_COPY);
+            out += numLiterals;
+            in += numLiterals;
+            size_t offset = in[0] | (in[1] << 8);
+            in += 2;
+            if (offset == 0 || offset > (size_t)(out - destination)){
+                return -1;
+            }
+            matchLength += LZ_MIN_MATCH;
+            if (offset >= LZ_COPY_CHUNK){
+                memcpy(out, out - offset, LZ_COPY_CHUNK);
+                memcpy(out + LZ_COPY_CHUNK, out - offset + LZ_COPY_CHUNK,
+                        LZ_COPY_CHUNK);
+                memcpy(out + 2 * LZ_COPY_CHUNK,
+                        out - offset + 2 * LZ_COPY_CHUNK, LZ_COPY_CHUNK);
+            }
+            else{
+                copyLzMatch(out, offset, matchLength);
+            }
+            out += matchLength;
+            continue;
+        }
+
+        if (numLiterals == LZ_LENGTH_MASK &&
+            !readLzLength(&in, end, &numLiterals)){
+            return -1;
+        }
+        if (numLiterals > (size_t)(end - in) ||
+            numLiterals > (size_t)(outEnd - out)){
+            return -1;
+        }
+        if (numLiterals <= LZ_WILD_COPY &&
+            end - in >= LZ_WILD_COPY && outEnd - out >= LZ_WILD_COPY){
+            memcpy(out, in, LZ_WILD_COPY);
+        }
+        else{
+            memcpy(out, in, numLiterals);
+        }
+        out += numLiterals;
+        in += numLiterals;
+        if (in == end){ // Last sequence, only literals
+            break;
+        }
+
+        if (end - in < 2){
+            return -1;
+        }
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        if ((matchLength == LZ_LENGTH_MASK &&
+            !readLzLength(&in, end, &matchLength)) ||
+            offset == 0 || offset > (size_t)(out - destination)){
+            return -1;
+        }
+        matchLength += LZ_MIN_MATCH;
+        if (matchLength > (size_t)(outEnd - out)){
+            return -1;
+        }
+
+        if (matchLength + LZ_WILD_COPY <= (size_t)(outEnd - out)){
+            copyLzMatch(out, offset, matchLength);
+            out += matchLength;
+        }
+        else{ // The end of the destination, copied exactly
+            for (; matchLength > 0; matchLength--, out++){
+                *out = *(out - offset);
+            }
+        }
+    }
+
+    return out - destination;
+}
+
+
+/**
+ * @brief Creates a writer of a segment file, writing its magic.
+ *
+ * @param file The file, open for writing.
+ * @return Pointer to the new writer.
+ */
+LzWriter* newLzWriter(FILE* file){
+    LzWriter* writer = (LzWriter*)malloc(sizeof(LzWriter));
+
+    writer->file = file;
+    writer->block = (unsigned char*)malloc(LZ_BLOCK_SIZE);
+    writer->blockLength = 0;
+    writer->compressed = (unsigned char*)malloc(LZ_BOUND(LZ_BLOCK_SIZE));
+    writer->rawBytes = 0;
+    writer->fileBytes = LZ_MAGIC_LENGTH;
+    writer->nanoseconds = 0;
+    fwrite(LZ_MAGIC, 1, LZ_MAGIC_LENGTH, file);
+
+    return writer;
+}
+
+
+/**
+ * @brief Compresses the bytes held by a writer and writes them as a block.
+ *
+ * @param writer Pointer to the writer.
+ */
+void flushLzBlock(LzWriter* writer){
+    unsigned char header[8];
+
+    if (writer->blockLength == 0){
+        return;
+    }
+    unsigned long long start = clockNanoseconds();
+    size_t length = lzCompress(writer->block, writer->blockLength,
+                                writer->compressed);
+    writer->nanoseconds += clockNanoseconds() - start;
+
+    // A block that doesn't shrink is stored as it is
+    const unsigned char* data = writer->compressed;
+    if (length >= writer->blockLength){
+        length = writer->blockLength;
+        data = writer->block;
+    }
+    writeLz32(header, (unsigned int)writer->blockLength);
+    writeLz32(header + 4, (unsigned int)length);
+    fwrite(header, 1, sizeof(header), writer->file);
+    fwrite(data, 1, length, writer->file);
+
+    writer->rawBytes += writer->blockLength;
+    writer->fileBytes += sizeof(header) + length;
+    writer->blockLength = 0;
+}
+
+
+/**
+ * @brief Writes bytes to a segment file, a block at a time.
+ *
+ * @param writer Pointer to the writer.
+ * @param data The bytes.
+ * @param length Number of bytes.
+ */
+void lzWrite(LzWriter* writer, const char* data, size_t length){
+    while (length > 0){
+        size_t room = LZ_BLOCK_SIZE - writer->blockLength;
+        size_t n = length < room ? length : room;
+        memcpy(writer->block + writer->blockLength, data, n);
+        writer->blockLength += n;
+        data += n;
+        length -= n;
+        if (writer->blockLength == LZ_BLOCK_SIZE){
+            flushLzBlock(writer);
+        }
+    }
+}
+
+
+/**
+ * @brief Writes the last block, closes the file and frees a writer.
+ *
+ * @param writer Pointer to the writer.
+ * @param path Path of the file, for the report.
+ * @param report Where to write the sizes and the speed of the compression.
+ */
+void closeLzWriter(LzWriter* writer, const char* path, FILE* report){
+    flushLzBlock(writer);
+    fclose(writer->file);
+
+    fprintf(report, "%s: %llu bytes compressed to %llu (%.1f%%), "
+            "%.1f MB/s\n", path, writer->rawBytes, writer->fileBytes,
+            writer->rawBytes ? 100.0 * writer->fileBytes / writer->rawBytes
+                             : 0.0,
+            writer->nanoseconds ?
+                1000.0 * writer->rawBytes / writer->nanoseconds : 0.0);
+
+    free(writer->block);
+    free(writer->compressed);
+    free(writer);
+}
+
+
+/**
+ * @brief Reads and decompresses the next block of a segment file.
+ *
+ * @param reader Pointer to the reader.
+ * @return 1 if a block was read, 0 at the end of the file, -1 if the file
+ * is corrupt (the error is printed).
+ */
+int readLzBlock(LzReader* reader){
+    unsigned char header[8];
+
+    size_t n = fread(header, 1, sizeof(header), reader->file);
+    if (n == 0){
+        return 0;
+    }
+    unsigned int rawLength = readLz32(header);
+    unsigned int length = readLz32(header + 4);
+    if (n != sizeof(header) || rawLength > LZ_BLOCK_SIZE ||
+        length > rawLength ||
+        fread(reader->compressed, 1, length, reader->file) != length){
+        fprintf(stderr, "%s: corrupt segment\n", reader->path);
+        return -1;
+    }
+
+    unsigned long long start = clockNanoseconds();
+    if (length == rawLength){
+        memcpy(reader->block, reader->compressed, length);
+    }
+    else if (lzDecompress(reader->compressed, length, reader->block,
+                            LZ_BLOCK_SIZE) != (long)rawLength){
+        fprintf(stderr, "%s: corrupt segment\n", reader->path);
+        return -1;
+    }
+    reader->nanoseconds += clockNanoseconds() - start;
+
+    reader->blockLength = rawLength;
+    reader->position = 0;
+    reader->rawBytes += rawLength;
+    reader->fileBytes += sizeof(header) + length;
+    return 1;
+}
+
+
+/**
+ * @brief Reads decompressed bytes of a segment file (read function of its
+ * stdio stream).
+ *
+ * @param cookie Pointer to the reader.
+ * @param buffer Where to write the bytes.
+ * @param size Maximum number of bytes.
+ * @return Number of bytes read, 0 at the end of the file, -1 on error.
+ */
+ssize_t readLzStream(void* cookie, char* buffer, size_t size){
+    LzReader* reader = (LzReader*)cookie;
+
+    while (reader->position == reader->blockLength){
+        int result = readLzBlock(reader);
+        if (result <= 0){
+            return result;
+        }
+    }
+
+    size_t n = reader->blockLength - reader->position;
+    n = n < size ? n : size;
+    memcpy(buffer, reader->block + reader->position, n);
+    reader->position += n;
+    return (ssize_t)n;
+}
+
+
+/**
+ * @brief Reports the decompression, closes the file and frees a reader
+ * (close function of its stdio stream).
+ *
+ * @param cookie Pointer to the reader.
+ * @return 0.
+ */
+int closeLzStream(void* cookie){
+    LzReader* reader = (LzReader*)cookie;
+
+    fprintf(stderr, "%s: %llu bytes decompressed from %llu, %.1f MB/s\n",
+            reader->path, reader->rawBytes, reader->fileBytes,
+            reader->nanoseconds ?
+                1000.0 * reader->rawBytes / reader->nanoseconds : 0.0);
+
+    fclose(reader->file);
+    free(reader->block);
+    free(reader->compressed);
+    free(reader);
+    return 0;
+}
+
+
+/**
+ * @brief Opens an event file for reading, decompressing it if it is a
+ * segment file.
+ *
+ * Commands never start with the first letter of LZ_MAGIC, so a single
+ * character tells them apart, even when the file is a pipe.
+ *
+ * @param path Path of the file.
+ * @param buffer Read buffer for the file, or NULL for the default one.
+ * @param size Size of the buffer.
+ * @return The stream, or NULL if the file can't be opened or isn't a valid
+ * segment file (the error is printed).
+ */
+FILE* openEventFile(const char* path, char* buffer, size_t size){
+    char magic[LZ_MAGIC_LENGTH];
+    FILE* file = fopen(path, "r");
+
+    if (file == NULL){
+        perror(path);
+        return NULL;
+    }
+    // The buffer must be set before the first read. A segment file's
+    // stream reads the file through it, so the reads stay few either way
+    if (buffer != NULL){
+        setvbuf(file, buffer, _IOFBF, size);
+    }
+    int first = getc(file);
+    if (first != LZ_MAGIC[0]){
+        ungetc(first, file);
+        return file;
+    }
+
+    magic[0] = (char)first;
+    if (fread(magic + 1, 1, LZ_MAGIC_LENGTH - 1, file) !=
+        LZ_MAGIC_LENGTH - 1 || memcmp(magic, LZ_MAGIC, LZ_MAGIC_LENGTH)){
+        fprintf(stderr, "%s: not a segment file\n", path);
+        fclose(file);
+        return NULL;
+    }
+
+    LzReader* reader = (LzReader*)malloc(sizeof(LzReader));
+    reader->file = file;
+    reader->path = path;
+    reader->block = (unsigned char*)malloc(LZ_BLOCK_SIZE);
+    reader->blockLength = 0;
+    reader->position = 0;
+    reader->compressed = (unsigned char*)malloc(LZ_BLOCK_SIZE);
+    reader->rawBytes = 0;
+    reader->fileBytes = LZ_MAGIC_LENGTH;
+    reader->nanoseconds = 0;
+
+    cookie_io_functions_t functions = {readLzStream, NULL, NULL,
+                                        closeLzStream};
+    return fopencookie(reader, "r", functions);
+}
@@ -0,0 +1,84 @@
+/**
+ * Definition of the compressed segment structs, and of the function
+ * prototypes related to them.
+ *
+ * Event files are dominated by repeated plates, park names and timestamps,
+ * so they are stored in segments compressed with a small LZ77 codec. A
+ * block is a run of sequences, each one made of a token, literals and a
+ * match:
+ *
+ *   token: high 4 bits literal length, low 4 bits match length - 4 (15
+ *          means more length follows, in bytes of 255 ended by a smaller
+ *          one)
+ *   literals: copied as they are
+ *   offset: 2 bytes, little endian, distance back to the match (1 to 65535)
+ *
+ * The last sequence of a block has only literals. Matches are found
+ * greedily with a hash table of the last position of each 4 bytes, and
+ * decoding is plain copies, fast enough not to slow down a replay.
+ *
+ * A segment file is LZ_MAGIC followed by blocks, each one preceded by its
+ * uncompressed and compressed lengths (4 bytes each, little endian), a
+ * block that doesn't shrink being stored as it is.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef LZ_H
+#define LZ_H
+
+#include <stdio.h>
+
+// Magic at the start of a segment file
+#define LZ_MAGIC "LZS1"
+// Length of LZ_MAGIC
+#define LZ_MAGIC_LENGTH 4
+// Maximum uncompressed length of a block
+#define LZ_BLOCK_SIZE (1 << 18)
+// Maximum compressed length of a block of n bytes
+#define LZ_BOUND(n) ((n) + (n) / 255 + 16)
+// Shortest match encoded
+#define LZ_MIN_MATCH 4
+// Longest distance back of a match
+#define LZ_MAX_OFFSET 65535
+// Number of bits of the hash of 4 bytes
+#define LZ_HASH_BITS 14
+// Bytes at the end of a block always left as literals
+#define LZ_LAST_LITERALS 5
+
+typedef struct lzWriter {
+    FILE* file;
+    unsigned char* block; // uncompressed bytes not yet written
+    size_t blockLength;
+    unsigned char* compressed; // compressed block being written
+    unsigned long long rawBytes; // uncompressed bytes written so far
+    unsigned long long fileBytes; // bytes of the file so far
+    unsigned long long nanoseconds; // time spent compressing
+} LzWriter;
+
+typedef struct lzReader {
+    FILE* file;
+    const char* path; // path of the file, for the report
+    unsigned char* block; // decompressed block being read
+    size_t blockLength;
+    size_t position; // position of the next byte to read in block
+    unsigned char* compressed; // compressed block read from the file
+    unsigned long long rawBytes; // decompressed bytes so far
+    unsigned long long fileBytes; // bytes of the file so far
+    unsigned long long nanoseconds; // time spent decompressing
+} LzReader;
+
+
+// Block codec
+size_t lzCompress(const unsigned char* source, size_t length,
+                    unsigned char* destination);
+long lzDecompress(const unsigned char* source, size_t length,
+                    unsigned char* destination, size_t capacity);
+
+// Writing segments
+LzWriter* newLzWriter(FILE* file);
+void lzWrite(LzWriter* writer, const char* data, size_t length);
+void closeLzWriter(LzWriter* writer, const char* path, FILE* report);
+
+// Reading event files, compressed or not
+FILE* openEventFile(const char* path, char* buffer, size_t size);
+#endif
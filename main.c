@@ -12,22 +12,86 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "allocs.h"
+#include "command.h"
+#include "config.h"
+#include "dedupe.h"
+#include "digest.h"
+#include "events.h"
+#include "group.h"
+#include "lz.h"
+#include "merge.h"
+#include "output.h"
 #include "park.h"
+#include "reorder.h"
+#include "replay.h"
+#include "report.h"
+#include "slowlog.h"
+#include "trace.h"
 
+int processCommand(char entry_data[BUFSIZ]);
+void checkSlowCommand(char entry_data[BUFSIZ], const SlowCommand* command);
+int readCommand(FeedMerger* merger, char entry_data[BUFSIZ]);
+int feedCommand(ReorderBuffer* reorder, char entry_data[BUFSIZ]);
+void releaseCommands(ReorderBuffer* reorder, int all);
+void replayCommands(FILE* file);
 void command_p(char entry_data[BUFSIZ]);
 
 int valid_inputs_commands_e_s(const char command, const char* parkName,
-    const char plate[PLATE_LENGTH], const Timestamp* timestamp);
+    const char plate[PLATE_LENGTH], const Timestamp* timestamp,
+    const EntryExitHandle* handle);
 
 void commands_e_s(char entry_data[BUFSIZ]);
 void command_v(char entry_data[BUFSIZ]);
 void command_f(char entry_data[BUFSIZ]);
 void command_r(char entry_data[BUFSIZ]);
+void commands_i_d(char entry_data[BUFSIZ]);
+void command_o();
+void command_a(char entry_data[BUFSIZ]);
+void command_g(char entry_data[BUFSIZ]);
+void command_c(char entry_data[BUFSIZ]);
+void command_x(char entry_data[BUFSIZ]);
+void command_u(char entry_data[BUFSIZ]);
+void command_w(char entry_data[BUFSIZ]);
+void command_n(char entry_data[BUFSIZ]);
+char* readParkName(char* str, char** parkName);
 
 // headPark stores a pointer to the first park in a parks linked list
 Park* headPark = NULL;
+// Parks by their name
+ParkMap parkIndex;
 // Timestamp for the last entry/exit in a parking
 Timestamp lastTimestamp;
+// Dictionary giving every plate seen in an entry a dense id
+PlateDict* plateDict = NULL;
+// Parks by their number of available spots
+AvailabilityIndex availability;
+// Season passes and exemptions valid in every park
+PassSet* passes = NULL;
+// headGroup stores a pointer to the first park group in a linked list
+ParkGroup* headGroup = NULL;
+// Subscriptions to plate entries/exits and to park occupancy thresholds
+EventBus* eventBus = NULL;
+// Ids of the recently accepted entries/exits, to drop retried commands
+DedupeFilter* dedupeFilter = NULL;
+// Billing reports being printed a slice at a time, by the order of the 'f'
+BillingReport* pendingReports = NULL;
+// Exits processed by a billing report after each command (0: whole report)
+unsigned int reportSlice = 0;
+// Where the responses to entries/exits, 'v' and 'f' are written
+Output output = {0, NULL};
+// Hash of every answer, when they're digested instead of written (-d)
+Digest outputDigest;
+// Workers running the batch jobs (reports, sorting, freeing the parks)
+Scheduler* scheduler = NULL;
+// Log of the commands processed, compressed (NULL: not logging)
+LzWriter* commandLog = NULL;
+// Commands slower than a threshold, with their context (NULL: disabled)
+SlowLog* slowLog = NULL;
+// Spans of the commands and of their internals (NULL: tracing disabled)
+Tracer* tracer = NULL;
+// Allocations made by the commands (only counted with COUNT_ALLOCATIONS)
+AllocationStats allocationStats;
 
 
 /**
@@ -36,46 +100,359 @@ Timestamp lastTimestamp;
  * Reads user input from stdin and executes corresponding commands until
  * termination command is received.
  * 
- * @return 0 on successful completion.
+ * @param argc Number of command line arguments.
+ * @param argv The command line arguments (see parseConfig).
+ * @return 0 on successful completion, 1 if the options or the replayed file
+ * are not valid.
  */
-int main(){
+int main(int argc, char* argv[]){
     char entry_data[BUFSIZ]; // Stores the user input
+    Config config;
+    ReorderBuffer* reorder = NULL;
+
+    if (!parseConfig(argc, argv, &config)){
+        return 1;
+    }
+    FILE* replayFile = NULL;
+    FILE* traceFile = NULL;
+    if (config.replayPath != NULL &&
+        (replayFile = openEventFile(config.replayPath, NULL, 0)) == NULL){
+        return 1;
+    }
+    if (config.tracePath != NULL &&
+        (traceFile = fopen(config.tracePath, "w")) == NULL){
+        perror(config.tracePath);
+        return 1;
+    }
+    if (config.logPath != NULL){
+        FILE* logFile = fopen(config.logPath, "w");
+        if (logFile == NULL){
+            perror(config.logPath);
+            return 1;
+        }
+        commandLog = newLzWriter(logFile);
+    }
+    FeedMerger* merger = NULL;
+    if (config.numFeeds > 0 &&
+        (merger = newFeedMerger(config.feedPaths, config.numFeeds)) == NULL){
+        return 1;
+    }
+    if (config.reorderWatermark != OPTION_UNSET){
+        reorder = newReorderBuffer(config.reorderWatermark);
+    }
+    scheduler = newScheduler(config.numWorkers);
+    if (config.tracePath != NULL || config.spanStats){
+        tracer = newTracer(config.spanStats);
+    }
+    // Every answer, in text or binary, is hashed by the stream installed
+    // as stdout, which the slow log then counts
+    FILE* realStdout = stdout;
+    if (config.digestOutput){
+        initDigest(&outputDigest);
+        stdout = openDigestStream(&outputDigest);
+    }
+    if (config.slowThreshold != OPTION_UNSET){
+        slowLog = newSlowLog(config.slowThreshold, stderr);
+    }
+    output.binary = config.binaryOutput || config.digestOutput;
+    output.stream = stdout;
+    if (config.reportSlice != OPTION_UNSET){
+        reportSlice = (unsigned int)config.reportSlice;
+    }
     lastTimestamp = INITIAL_TIMESTAMP;
+    plateDict = newPlateDict();
+    parkMapInit(&parkIndex);
+    initAvailabilityIndex(&availability);
+    passes = newPassSet();
+    eventBus = newEventBus();
+    dedupeFilter = newDedupeFilter();
+    initAllocationStats(&allocationStats);
 
     // Main loop to get a full line of input, and process it
-    while (fgets(entry_data, sizeof(entry_data), stdin) != NULL){
-        // First character of the input determines the command
-        switch (entry_data[0]){
-            case 'q': // quit
-                freeAllParks(headPark);
-                return 0;
-            case 'p': // Show parks or create a new one
-                command_p(entry_data);
-                break;
-            case 'e': // Vehicle entry in a park
-            case 's': // Vehicle exit out of a park
-                commands_e_s(entry_data);
-                break;
-            case 'v': // List the park usage by a certain vehicle
-                command_v(entry_data);
-                break;
-            case 'f': // List a parks billing
-                command_f(entry_data);
-                break;
-            case 'r': // Remove a park from the system
-                command_r(entry_data);
+    if (replayFile != NULL){
+        replayCommands(replayFile);
+        fclose(replayFile);
+    }
+    while (replayFile == NULL && readCommand(merger, entry_data)){
+        if (!feedCommand(reorder, entry_data)){
+            break;
         }
     }
+    if (merger != NULL){
+        freeFeedMerger(merger);
+    }
 
+    // Entries/exits still held when the input ends are processed in order
+    if (reorder != NULL){
+        releaseCommands(reorder, 1);
+        freeReorderBuffer(reorder);
+    }
+    finishParkReports(&pendingReports, NULL);
+    if (slowLog != NULL){
+        freeSlowLog(slowLog);
+    }
+    if (config.digestOutput){
+        // Closing the digest stream hashes what it still holds
+        fclose(stdout);
+        stdout = realStdout;
+        printf("%016llx\n", digestValue(&outputDigest));
+    }
+    if (commandLog != NULL){
+        closeLzWriter(commandLog, config.logPath, stderr);
+    }
+    freeAllParks(headPark, scheduler);
+    parkMapFree(&parkIndex);
+    freeAvailabilityIndex(&availability);
+    freeParkGroups(headGroup);
+    freePassSet(passes);
+    freePlateDict(plateDict);
+    freeEventBus(eventBus);
+    freeDedupeFilter(dedupeFilter);
+    freeScheduler(scheduler);
+    if (traceFile != NULL){
+        writeTrace(tracer, traceFile);
+        fclose(traceFile);
+    }
+    if (config.spanStats){
+        writeSpanStats(tracer, stderr);
+    }
+    freeTracer(tracer);
+    if (countingAllocations()){
+        writeAllocationStats(&allocationStats, stderr);
+    }
     return 0;
 }
 
 
+/**
+ * @brief Processes a single command.
+ * 
+ * @param entry_data The input command string.
+ * @return 0 if the command is the termination command, 1 otherwise.
+ */
+int processCommand(char entry_data[BUFSIZ]){
+    SpanStart start = traceBegin(tracer);
+    unsigned long allocations = getAllocationCount();
+    SlowCommand slowStart = {0, 0};
+
+    if (slowLog != NULL){
+        slowStart = startSlowCommand(slowLog);
+    }
+    if (commandLog != NULL){
+        lzWrite(commandLog, entry_data, strlen(entry_data));
+    }
+    // First character of the input determines the command
+    switch (entry_data[0]){
+        case 'q': // quit
+            finishParkReports(&pendingReports, NULL);
+            traceEnd(tracer, commandSpanName('q'), &start);
+            recordAllocations(&allocationStats, 'q',
+                                getAllocationCount() - allocations);
+            checkSlowCommand(entry_data, &slowStart);
+            return 0;
+        case 'p': // Show parks or create a new one
+            command_p(entry_data);
+            break;
+        case 'e': // Vehicle entry in a park
+        case 's': // Vehicle exit out of a park
+            commands_e_s(entry_data);
+            break;
+        case 'v': // List the park usage by a certain vehicle
+            command_v(entry_data);
+            break;
+        case 'f': // List a parks billing
+            command_f(entry_data);
+            break;
+        case 'r': // Remove a park from the system
+            command_r(entry_data);
+            break;
+        case 'i': // List the plates that visited both of two parks
+        case 'd': // List the plates that visited a park but not another
+            commands_i_d(entry_data);
+            break;
+        case 'o': // List the plates currently inside any park
+            command_o();
+            break;
+        case 'a': // Show the parks with available spots
+            command_a(entry_data);
+            break;
+        case 'g': // Show park groups or add a park to a group
+            command_g(entry_data);
+            break;
+        case 'c': // Correct a visit: amend its exit or void it
+            command_c(entry_data);
+            break;
+        case 'x': // Add a season pass or exemption
+            command_x(entry_data);
+            break;
+        case 'u': // Estimate the distinct vehicles that entered parks
+            command_u(entry_data);
+            break;
+        case 'w': // Watch a plate or a park's occupancy
+            command_w(entry_data);
+            break;
+        case 'n': // Show the notifications of a watch
+            command_n(entry_data);
+    }
+    // Reports in progress get a slice after each command
+    advanceReports(&pendingReports, reportSlice);
+    traceEnd(tracer, commandSpanName(entry_data[0]), &start);
+    recordAllocations(&allocationStats, entry_data[0],
+                        getAllocationCount() - allocations);
+    checkSlowCommand(entry_data, &slowStart);
+    return 1;
+}
+
+
+/**
+ * @brief Writes a command to the slow log, if it is in use and the command
+ * was slow.
+ * 
+ * The park of the command is its first argument, if that names a park (or
+ * named the park a 'r' just removed).
+ * 
+ * @param entry_data The input command string.
+ * @param command Pointer to the start of the command.
+ */
+void checkSlowCommand(char entry_data[BUFSIZ], const SlowCommand* command){
+    unsigned long long nanoseconds, written;
+    char* parkName = NULL;
+
+    if (slowLog == NULL ||
+        !endSlowCommand(slowLog, command, &nanoseconds, &written)){
+        return;
+    }
+
+    if (entry_data[0] != '\0'){
+        readParkName(entry_data + 1, &parkName);
+    }
+    Park* park = parkName != NULL ? getPark(&parkIndex, parkName) : NULL;
+    recordSlowCommand(slowLog, entry_data,
+                        park != NULL || entry_data[0] == 'r' ? parkName : NULL,
+                        park != NULL ? getTable(park) : NULL, written,
+                        nanoseconds);
+    free(parkName);
+}
+
+
+/**
+ * @brief Processes the commands held by the reorder buffer.
+ * 
+ * @param reorder Pointer to the reorder buffer.
+ * @param all 1 to process every command held, 0 to process only the ones
+ * already behind the watermark.
+ */
+void releaseCommands(ReorderBuffer* reorder, int all){
+    char* line;
+
+    while ((line = all ? reorderPop(reorder) :
+                        reorderPopReady(reorder)) != NULL){
+        processCommand(line);
+        free(line);
+    }
+}
+
+
+/**
+ * @brief Reads the next command, from the merged event files if any, or
+ * from stdin otherwise.
+ * 
+ * @param merger Pointer to the feed merger, or NULL if not in use.
+ * @param entry_data Where to store the command.
+ * @return 1 if a command was read, 0 at the end of the input.
+ */
+int readCommand(FeedMerger* merger, char entry_data[BUFSIZ]){
+    if (merger != NULL){
+        return mergeNextLine(merger, entry_data);
+    }
+    return fgets(entry_data, BUFSIZ, stdin) != NULL;
+}
+
+
+/**
+ * @brief Feeds a command to the system, through the reorder buffer if one
+ * is in use.
+ * 
+ * Entries and exits wait in the reorder buffer until they are behind the
+ * watermark. Any other command first processes every entry/exit held, so
+ * it sees the same state it would see without the reorder buffer.
+ * 
+ * @param reorder Pointer to the reorder buffer, or NULL if not in use.
+ * @param entry_data The input command string.
+ * @return 0 if the command is the termination command, 1 otherwise.
+ */
+int feedCommand(ReorderBuffer* reorder, char entry_data[BUFSIZ]){
+    char command;
+    char parkName[PARK_NAME_LENGTH];
+    char plate[PLATE_LENGTH];
+    Timestamp timestamp;
+    int consumed;
+
+    if (reorder == NULL){
+        return processCommand(entry_data);
+    }
+
+    if ((entry_data[0] == 'e' || entry_data[0] == 's') &&
+        parseEntryExit(entry_data, &command, parkName, plate, &timestamp,
+                        &consumed)){
+        // An invalid date will be rejected anyway: keep its arrival order
+        reorderPush(reorder, validTimestamp(&timestamp) ?
+                    timestampToMinutes(&timestamp) : getNewestMinute(reorder),
+                    entry_data);
+        releaseCommands(reorder, 0);
+        return 1;
+    }
+
+    releaseCommands(reorder, 1);
+    return processCommand(entry_data);
+}
+
+
+/**
+ * @brief Replays the commands of an event file.
+ * 
+ * Runs of entries/exits are gathered in segments and processed by the
+ * replay (see replay.h), with the same results as processing them one by
+ * one. Any other command ends the current segment and is processed alone.
+ * 
+ * @param file The event file.
+ */
+void replayCommands(FILE* file){
+    char entry_data[BUFSIZ];
+    ReplaySegment* segment = newReplaySegment();
+    ReplayContext context = {NULL, plateDict, eventBus, dedupeFilter,
+                                &availability, passes, &lastTimestamp,
+                                &output, scheduler, tracer};
+    int running = 1;
+
+    while (running && fgets(entry_data, sizeof(entry_data), file) != NULL){
+        // Reports in progress get their slices between the commands
+        if ((entry_data[0] == 'e' || entry_data[0] == 's') &&
+            pendingReports == NULL){
+            addReplayLine(segment, entry_data);
+            if (!replaySegmentFull(segment)){
+                continue;
+            }
+            entry_data[0] = '\0';
+        }
+
+        context.headPark = headPark;
+        replaySegment(segment, &context);
+        running = processCommand(entry_data);
+    }
+
+    context.headPark = headPark;
+    replaySegment(segment, &context);
+    freeReplaySegment(segment);
+}
+
+
 /**
  * @brief Processes the command to add a new park.
  * 
  * This function parses the input command and extracts the necessary
  * information to either display the current parks or to create a new park.
+ * The tariff of a new park may be followed by rules (see tariff.h).
  * 
  * @param entry_data The input command string, possibly containing information
  * about the new park.
@@ -84,15 +461,18 @@ void command_p(char entry_data[BUFSIZ]){
     char* parkName;
     int capacity;
     double value15, value15after1, valueMaxDaily;
+    int consumed = 0;
 
     // Use sscanf to parse the entry data
     // First try to match the park name if it is between quotes
-    int result = sscanf(entry_data, "p \"%m[^\"]\" %d%lf%lf%lf",
-        &parkName, &capacity, &value15, &value15after1, &valueMaxDaily);
+    int result = sscanf(entry_data, "p \"%m[^\"]\" %d%lf%lf%lf%n",
+        &parkName, &capacity, &value15, &value15after1, &valueMaxDaily,
+        &consumed);
     if (result != 5){
         // The park name is not between quotes
-        result = sscanf(entry_data, "p%ms%d%lf%lf%lf",
-            &parkName, &capacity, &value15, &value15after1, &valueMaxDaily);
+        result = sscanf(entry_data, "p%ms%d%lf%lf%lf%n",
+            &parkName, &capacity, &value15, &value15after1, &valueMaxDaily,
+            &consumed);
     }
 
     // If sscanf didn't read 5 values that means we just display the parks
@@ -104,13 +484,16 @@ void command_p(char entry_data[BUFSIZ]){
 
     // The command is to create a new park
     Tariff tariff = newTariff(&value15, &value15after1, &valueMaxDaily);
+    compileTariffRules(&tariff, entry_data + consumed);
     Park* park = newPark(parkName, &capacity, &tariff);
 
     // Add the park to the list
-    if (!addPark(&headPark, park)){
+    if (!addPark(&headPark, &parkIndex, park)){
         // If the adding was unsuccessful free allocated memory
         freePark(park);
+        return;
     }
+    indexPark(&availability, park);
 }
 
 
@@ -127,43 +510,45 @@ void command_p(char entry_data[BUFSIZ]){
  * @param parkName The name of the park.
  * @param plate The license plate of the vehicle.
  * @param timestamp Pointer to the timestamp indicating the entry or exit time.
+ * @param handle Pointer to the handle of the entry/exit (see findEntryExit).
  * @return int Returns 1 if all inputs are valid, otherwise returns 0.
  */
 int valid_inputs_commands_e_s(const char command, const char* parkName,
-const char plate[PLATE_LENGTH], const Timestamp* timestamp){
-    Park* park = getPark(headPark, parkName);
+const char plate[PLATE_LENGTH], const Timestamp* timestamp,
+const EntryExitHandle* handle){
+    Park* park = handle->park;
     // Verify if park exists
     if(park == NULL){
-        printf("%s: no such parking.\n", parkName);
+        outputError(&output, ERROR_NO_SUCH_PARKING, parkName);
         return 0;
     }
 
     // In case of an entry, verifiy if the park isn't full
     if(command == 'e' && *getAvailableSpots(park) <= 0){
-        printf("%s: parking is full.\n", parkName);
+        outputError(&output, ERROR_PARKING_FULL, parkName);
         return 0;
     }
 
     // Verify if the plate is valid
     if(!validPlate(plate)){
-        printf("%s: invalid licence plate.\n", plate);
+        outputError(&output, ERROR_INVALID_PLATE, plate);
         return 0;
     }
 
-    int plateIsInAnyPark = plateInAnyPark(headPark, plate);
+    int plateIsInAnyPark = handle->parksInside > 0;
     // Verify that the vehicle isn't already in a park in case of an entry
     // Or that it isn't already outside all parks in case of an exit
     if ((command == 'e' && plateIsInAnyPark) ||
     (command == 's' && !plateIsInAnyPark)){
-        printf("%s: invalid vehicle %s.\n",
-            plate, (command == 'e') ? "entry" : "exit");
+        outputError(&output,
+            (command == 'e') ? ERROR_INVALID_ENTRY : ERROR_INVALID_EXIT, plate);
         return 0;
     }
 
     // Verify that the timestamp is valid and not before lastTimestamp
     if (!validTimestamp(timestamp) ||
     compareTimestamps(&lastTimestamp, timestamp) == 1){
-        printf("invalid date.\n");
+        outputError(&output, ERROR_INVALID_DATE, "");
         return 0;
     }
 
@@ -179,41 +564,74 @@ const char plate[PLATE_LENGTH], const Timestamp* timestamp){
  * the entry or exit of a vehicle in a park and updating the last timestamp for
  * these events (entry/exit).
  * 
+ * The command may end with an event id. A command whose event id belongs to
+ * a recently accepted entry/exit is a retry, and is silently dropped.
+ * 
  * @param entry_data The input command string containing information about
  * the entry or exit event.
  */
 void commands_e_s(char entry_data[BUFSIZ]){
     char command;
-    char* parkName;
+    char parkName[PARK_NAME_LENGTH];
     char plate[PLATE_LENGTH];
-    int day, month, year, hour, minute;
+    Timestamp timestamp;
+    int consumed;
+    unsigned long long eventId;
+    SpanStart start = traceBegin(tracer);
 
-    // Use sscanf to parse the entry data
-    // First try to match the park name if it is between quotes
-    int result = sscanf(entry_data, "%c \"%m[^\"]\" %8s %d-%d-%d %d:%d",
-        &command, &parkName, plate, &day, &month, &year, &hour, &minute);
+    parseEntryExit(entry_data, &command, parkName, plate, &timestamp,
+                    &consumed);
+
+    // Optional event id after the hour
+    int hasEventId = parseEventId(entry_data, consumed, &eventId);
+    traceEnd(tracer, "parse", &start);
+    if (hasEventId && dedupeContains(dedupeFilter, eventId)){
+        return;
+    }
 
-    if (result != 8){ // The park name is not between quotes
-        result = sscanf(entry_data, "%c %ms %8s %d-%d-%d %d:%d",
-            &command, &parkName, plate, &day, &month, &year, &hour, &minute);
+    // Validate inputs, looking the park and the plate up only once
+    start = traceBegin(tracer);
+    EntryExitHandle handle = findEntryExit(&parkIndex, plateDict, parkName,
+                                            plate);
+    int valid = valid_inputs_commands_e_s(command, parkName, plate,
+                                            &timestamp, &handle);
+    traceEnd(tracer, "validate", &start);
+    if(!valid){
+        return;
     }
 
+    start = traceBegin(tracer);
+    Park* park = handle.park;
+    Log* log = applyEntryExit(&handle, plateDict, &availability, passes,
+                                plate, &timestamp, tracer);
+    unsigned int plateId = handle.plateId;
+    traceEnd(tracer, "apply", &start);
 
-    Timestamp timestamp = newTimestamp(day, month, year, hour, minute);
+    int entry = isInitialTimestamp(getExitTimestamp(log));
+    double cost = getLogCost(log);
+    recordGroupEntryExit(park, entry, cost);
 
-    // Validate inputs
-    if(!valid_inputs_commands_e_s(command, parkName, plate, &timestamp)){
-        free(parkName);
-        return;
+    start = traceBegin(tracer);
+    if (entry){
+        outputEntry(&output, parkName, *getAvailableSpots(park));
+    }
+    else {
+        outputExit(&output, log, cost);
     }
+    traceEnd(tracer, "print", &start);
 
-    Park* park = getPark(headPark, parkName);
-    registerEntryExit(park, plate, &timestamp);
+    // Notify the subscribers of the plate and of the park
+    publishEntryExit(eventBus, entry ? EVENT_ENTRY : EVENT_EXIT, plateId,
+        plate, parkName, *getCapacity(park) - *getAvailableSpots(park),
+        &timestamp);
 
     // Update last entry/exit timestamp to match the parsed timestamp
     copyTimestamp(&lastTimestamp, &timestamp);
 
-    free(parkName);
+    // Remember the event id so a retry of this command is dropped
+    if (hasEventId){
+        dedupeInsert(dedupeFilter, eventId, timestampToMinutes(&lastTimestamp));
+    }
 }
 
 
@@ -234,18 +652,23 @@ void command_v(char entry_data[BUFSIZ]){
 
     // Validate plate
     if (!validPlate(plate)){
-        printf("%s: invalid licence plate.\n", plate);
+        outputError(&output, ERROR_INVALID_PLATE, plate);
         return;
     }
 
     // Retrieve the plate entry/exit logs and display them, if they exist
-    Log* plateLogs = getPlateLogs(headPark, plate);
+    Log* plateLogs = getPlateLogs(headPark, plate, scheduler, tracer);
+    SpanStart start = traceBegin(tracer);
     if (plateLogs == NULL){
-        printf("%s: no entries found in any parking.\n", plate);
+        outputError(&output, ERROR_NO_ENTRIES, plate);
     }
     else{
-        printLog(plateLogs);
+        for (Log* log = plateLogs; log != NULL; log = log->next){
+            outputVisit(&output, log);
+        }
+        outputEnd(&output);
     }
+    traceEnd(tracer, "print", &start);
     freeLog(plateLogs);
 }
 
@@ -274,9 +697,9 @@ void command_f(char entry_data[BUFSIZ]){
     }
 
     // Verify if the park exists
-    Park* park = getPark(headPark, parkName);
+    Park* park = getPark(&parkIndex, parkName);
     if (park == NULL){
-        printf("%s: no such parking.\n", parkName);
+        outputError(&output, ERROR_NO_SUCH_PARKING, parkName);
         free(parkName);
         return;
     }
@@ -285,13 +708,21 @@ void command_f(char entry_data[BUFSIZ]){
     // Check if a date was passed in the command and if it was, validate it
     if (!isInitialTimestamp(&t)){
         if (!validTimestamp(&t) || compareTimestamps(&t, &lastTimestamp) == 1){
-            printf("invalid date.\n");
+            outputError(&output, ERROR_INVALID_DATE, "");
             free(parkName);
             return;
         }
     }
 
-    showParkBilling(park, &t);
+    BillingReport* report = newBillingReport(park, &t, &output, tracer);
+    if (reportSlice == 0){
+        advanceBillingReport(report, getNumExits(park));
+        freeBillingReport(report);
+    }
+    else {
+        // Printed a slice at a time, so entries/exits are not held back
+        enqueueReport(&pendingReports, report);
+    }
     free(parkName);
 }
 
@@ -315,10 +746,462 @@ void command_r(char entry_data[BUFSIZ]){
         sscanf(entry_data, "r %ms", &parkName);
     }
 
+    // Reports of the park must be finished before it is freed, the plates
+    // inside it no longer count as inside a park, its visits leave their
+    // plates' chains, and its watches end
+    Park* park = getPark(&parkIndex, parkName);
+    if (park != NULL){
+        finishParkReports(&pendingReports, park);
+        releaseOccupants(park, plateDict);
+        releaseVisits(park, plateDict);
+        unindexPark(&availability, park);
+        leaveParkGroups(park);
+        closeParkSubscriptions(eventBus, parkName);
+    }
+
     // Verify if park can successfuly be removed, and if so remove it
-    if (removePark(&headPark, parkName)){
+    if (removePark(&headPark, &parkIndex, parkName)){
         printParksAlphabetically(headPark);
     }
 
     free(parkName);
+}
+
+
+/**
+ * @brief Reads a park name, which may be between quotes, from a command.
+ * 
+ * @param str The part of the command where the park name starts.
+ * @param parkName Where to store the park name (allocated, to be freed by
+ * the caller), or NULL if no name was found.
+ * @return Pointer to the rest of the command after the park name, or NULL
+ * if no name was found.
+ */
+char* readParkName(char* str, char** parkName){
+    int consumed = 0;
+
+    // First try to match the park name if it is between quotes
+    *parkName = NULL;
+    if (sscanf(str, " \"%m[^\"]\"%n", parkName, &consumed) == 1){
+        return str + consumed;
+    }
+    // The park name is not between quotes
+    if (sscanf(str, "%ms%n", parkName, &consumed) == 1){
+        return str + consumed;
+    }
+    return NULL;
+}
+
+
+/**
+ * @brief Processes the commands comparing the visitors of two parks.
+ * 
+ * The 'i' command lists the plates that ever entered both parks, and the
+ * 'd' command lists the plates that ever entered the first park but never
+ * the second one. Plates are listed alphabetically.
+ * 
+ * @param entry_data The input command string containing the names of the
+ * two parks.
+ */
+void commands_i_d(char entry_data[BUFSIZ]){
+    char* parkNames[2] = {NULL, NULL};
+    Park* parks[2];
+    char* rest = entry_data + 1;
+
+    for (int i = 0; i < 2; i++){
+        if (rest != NULL){
+            rest = readParkName(rest, &parkNames[i]);
+        }
+    }
+    if (rest == NULL){ // Missing park names
+        free(parkNames[0]);
+        return;
+    }
+
+    // Verify that both parks exist
+    for (int i = 0; i < 2; i++){
+        parks[i] = getPark(&parkIndex, parkNames[i]);
+        if (parks[i] == NULL){
+            printf("%s: no such parking.\n", parkNames[i]);
+            free(parkNames[0]);
+            free(parkNames[1]);
+            return;
+        }
+    }
+
+    Bitmap* plates = (entry_data[0] == 'i') ?
+        bitmapAnd(getVisitors(parks[0]), getVisitors(parks[1])) :
+        bitmapAndNot(getVisitors(parks[0]), getVisitors(parks[1]));
+    printPlateSet(plateDict, plates);
+
+    freeBitmap(plates);
+    free(parkNames[0]);
+    free(parkNames[1]);
+}
+
+
+/**
+ * @brief Processes the command to show the parks with available spots.
+ * 
+ * Without a number, shows the park with the most available spots. With a
+ * number, shows every park with at least that many available spots, from
+ * the most spots to the fewest. Parks are shown as in the 'p' command.
+ * 
+ * @param entry_data The input command string, possibly with the number of
+ * available spots.
+ */
+void command_a(char entry_data[BUFSIZ]){
+    int minimum;
+
+    if (sscanf(entry_data, "a %d", &minimum) != 1){
+        Park* park = mostAvailablePark(&availability);
+        if (park == NULL || *getAvailableSpots(park) <= 0){
+            printf("no parking with available spots.\n");
+            return;
+        }
+        printf("%s %d %d\n", getParkName(park), *getCapacity(park),
+                *getAvailableSpots(park));
+        return;
+    }
+
+    if (minimum < 0){
+        printf("%d: invalid number of spots.\n", minimum);
+        return;
+    }
+    if (printParksWithSpots(&availability, minimum) == 0){
+        printf("no parking with available spots.\n");
+    }
+}
+
+
+/**
+ * @brief Processes the command to show park groups or add a park to one.
+ * 
+ * Without names, shows every group. With a group name, shows that group.
+ * With a group name and a park name, adds the park to the group, creating
+ * the group if it doesn't exist. Groups are shown with their number of
+ * parks, capacity, available spots and revenue.
+ * 
+ * @param entry_data The input command string, possibly with the names.
+ */
+void command_g(char entry_data[BUFSIZ]){
+    char* groupName;
+    char* parkName = NULL;
+    char* rest = readParkName(entry_data + 1, &groupName);
+
+    if (rest == NULL){ // No group: show them all
+        printParkGroups(headGroup);
+        return;
+    }
+
+    ParkGroup* group = getParkGroup(headGroup, groupName);
+    if (readParkName(rest, &parkName) == NULL){ // No park: show the group
+        if (group == NULL){
+            printf("%s: no such group.\n", groupName);
+        }
+        else {
+            printParkGroup(group);
+        }
+        free(groupName);
+        return;
+    }
+
+    Park* park = getPark(&parkIndex, parkName);
+    if (park == NULL){
+        printf("%s: no such parking.\n", parkName);
+        free(groupName);
+        free(parkName);
+        return;
+    }
+    free(parkName);
+
+    if (group == NULL){
+        // The group keeps its name, add it to the end of the list
+        group = newParkGroup(groupName);
+        ParkGroup** last = &headGroup;
+        while (*last != NULL){
+            last = &(*last)->next;
+        }
+        *last = group;
+    }
+    else {
+        free(groupName);
+    }
+    if (!addParkToGroup(group, park)){
+        printf("%s: parking already in group.\n", getParkName(park));
+    }
+}
+
+
+/**
+ * @brief Processes the command correcting a visit after the fact.
+ * 
+ * The visit is given by its park, plate and entry timestamp, as in an
+ * entry. With an exit timestamp after those, the visit's exit is amended
+ * (or registered, if the vehicle is still inside); without one, the visit
+ * is voided, as if it never happened. The park's exits, the groups' totals
+ * and the availability index are updated by the difference only. Freeing
+ * the spot of a vehicle still inside is published like an exit: an amended
+ * exit to the plate's and the park's subscribers, a void (which has no exit
+ * timestamp) to the park's occupancy subscribers only, at the last
+ * entry/exit timestamp.
+ * 
+ * The park's exits are updated in O(log n) expected time (see
+ * correctVisit), and an amended exit is only checked against the plate's
+ * own visits (visitOverlaps). Finding the visit walks the plate's logs in
+ * the park's table.
+ * 
+ * @param entry_data The input command string containing the visit, and
+ * optionally its new exit timestamp.
+ */
+void command_c(char entry_data[BUFSIZ]){
+    char command;
+    char parkName[PARK_NAME_LENGTH];
+    char plate[PLATE_LENGTH];
+    Timestamp entry, exit;
+    int consumed;
+
+    int parsed = parseEntryExit(entry_data, &command, parkName, plate, &entry,
+                                &consumed);
+    int amend = parseCorrectedExit(entry_data, consumed, &exit);
+
+    Park* park = getPark(&parkIndex, parkName);
+    if (park == NULL){
+        printf("%s: no such parking.\n", parkName);
+        return;
+    }
+    if (!validPlate(plate)){
+        printf("%s: invalid licence plate.\n", plate);
+        return;
+    }
+    Log* visit = parsed ? getPlateLogAt(getTable(park), plate, &entry) : NULL;
+    if (visit == NULL){
+        printf("%s: no such visit.\n", plate);
+        return;
+    }
+
+    // The exit can't be before the entry, nor after the last entry/exit
+    if (amend && (!validTimestamp(&exit) ||
+        compareTimestamps(&exit, &entry) < 0 ||
+        compareTimestamps(&exit, &lastTimestamp) > 0)){
+        printf("invalid date.\n");
+        return;
+    }
+    if (amend && visitOverlaps(plateDict, visit, &exit)){
+        printf("%s: invalid vehicle exit.\n", plate);
+        return;
+    }
+
+    // Reports of the park hold positions of its exits
+    finishParkReports(&pendingReports, park);
+    int wasInside = isInitialTimestamp(getExitTimestamp(visit));
+    double revenueDelta = correctVisit(park, plateDict, &availability,
+                                        passes, visit, amend ? &exit : NULL);
+    recordGroupCorrection(park, wasInside, revenueDelta);
+
+    if (wasInside){
+        int occupancy = *getCapacity(park) - *getAvailableSpots(park);
+        if (amend){
+            char* visitPlate = getLogPlate(visit);
+            publishEntryExit(eventBus, EVENT_EXIT,
+                findPlateId(plateDict, visitPlate), visitPlate,
+                getParkName(park), occupancy, &exit);
+        }
+        else {
+            publishOccupancy(eventBus, EVENT_EXIT, getParkName(park),
+                                occupancy, &lastTimestamp);
+        }
+    }
+}
+
+
+/**
+ * @brief Processes the command adding a season pass or exemption.
+ * 
+ * The pass is valid from its first to its last day (both included), in
+ * the given park or, without a park, in every park. Exits on those days
+ * are billed zero.
+ * 
+ * @param entry_data The input command string containing the plate, the
+ * first and last days and optionally the park name.
+ */
+void command_x(char entry_data[BUFSIZ]){
+    char plate[PLATE_LENGTH] = "";
+    int firstDay = 0, firstMonth = 0, firstYear = 0;
+    int lastDay = 0, lastMonth = 0, lastYear = 0;
+    int consumed = 0;
+
+    int result = sscanf(entry_data, "x %8s %d-%d-%d %d-%d-%d%n", plate,
+                        &firstDay, &firstMonth, &firstYear,
+                        &lastDay, &lastMonth, &lastYear, &consumed);
+    if (!validPlate(plate)){
+        printf("%s: invalid licence plate.\n", plate);
+        return;
+    }
+    Timestamp first = newTimestamp(firstDay, firstMonth, firstYear, 0, 0);
+    Timestamp last = newTimestamp(lastDay, lastMonth, lastYear, 0, 0);
+    if (result != 7 || !validTimestamp(&first) || !validTimestamp(&last) ||
+        compareDate(&first, &last) > 0){
+        printf("invalid date.\n");
+        return;
+    }
+
+    char* parkName;
+    if (readParkName(entry_data + consumed, &parkName) == NULL){
+        addPass(passes, plate, &first, &last);
+        return;
+    }
+    Park* park = getPark(&parkIndex, parkName);
+    if (park == NULL){
+        printf("%s: no such parking.\n", parkName);
+    }
+    else {
+        addParkPass(park, plate, &first, &last);
+    }
+    free(parkName);
+}
+
+
+/**
+ * @brief Processes the command listing the plates currently inside any park.
+ * 
+ * Plates are listed alphabetically.
+ */
+void command_o(){
+    Bitmap* plates = occupantsOfAllParks(headPark);
+    printPlateSet(plateDict, plates);
+    freeBitmap(plates);
+}
+
+
+/**
+ * @brief Processes the command estimating distinct visitors of parks.
+ * 
+ * Without arguments it estimates the distinct vehicles that ever entered
+ * any park. With a park name it lists the estimate of each day, and with a
+ * park name and a date (or two dates) it estimates the distinct vehicles
+ * that entered the park in that day (or in that range of days).
+ * 
+ * @param entry_data The input command string, possibly containing the park
+ * name and the dates.
+ */
+void command_u(char entry_data[BUFSIZ]){
+    char* parkName;
+    char* rest = readParkName(entry_data + 1, &parkName);
+    HyperLogLog visitors;
+    initHyperLogLog(&visitors);
+
+    // No park given: merge every day of every park
+    if (rest == NULL){
+        for (Park* park = headPark; park != NULL; park = park->next){
+            mergeParkVisitors(park, NULL, NULL, &visitors);
+        }
+        printf("%.0f\n", hllEstimate(&visitors));
+        return;
+    }
+
+    Park* park = getPark(&parkIndex, parkName);
+    if (park == NULL){
+        printf("%s: no such parking.\n", parkName);
+        free(parkName);
+        return;
+    }
+    free(parkName);
+
+    int d1, m1, y1, d2, m2, y2;
+    int result = sscanf(rest, "%d-%d-%d %d-%d-%d", &d1, &m1, &y1,
+                        &d2, &m2, &y2);
+    if (result < 3){ // No dates: list every day
+        printDailyVisitors(park);
+        return;
+    }
+
+    Timestamp from = newTimestamp(d1, m1, y1, 0, 0);
+    Timestamp to = (result == 6) ? newTimestamp(d2, m2, y2, 0, 0) : from;
+    if (!validTimestamp(&from) || !validTimestamp(&to) ||
+        compareDate(&from, &to) > 0){
+        printf("invalid date.\n");
+        return;
+    }
+
+    mergeParkVisitors(park, &from, &to, &visitors);
+    if (result == 6){
+        printf("%.0f\n", hllEstimate(&visitors));
+    }
+    else{
+        printDate(&from);
+        printf(" %.0f\n", hllEstimate(&visitors));
+    }
+}
+
+
+/**
+ * @brief Processes the command to watch a plate or a park.
+ * 
+ * With a plate, the new subscriber is notified of every entry and exit of
+ * that plate. With a park name and a threshold, it is notified when the
+ * number of vehicles inside the park reaches the threshold or goes back
+ * under it. The id of the new subscriber is printed.
+ * 
+ * @param entry_data The input command string containing the plate, or the
+ * park name and the occupancy threshold.
+ */
+void command_w(char entry_data[BUFSIZ]){
+    char* target;
+    char* rest = readParkName(entry_data + 1, &target);
+    int threshold;
+
+    if (rest == NULL){
+        return;
+    }
+
+    // A plate is watched for its entries and exits
+    if (strlen(target) == PLATE_LENGTH - 1 && validPlate(target)){
+        printf("%d\n",
+            subscribePlate(eventBus, internPlate(plateDict, target))->id);
+        free(target);
+        return;
+    }
+
+    Park* park = getPark(&parkIndex, target);
+    if (park == NULL){
+        printf("%s: no such parking.\n", target);
+    }
+    else if (sscanf(rest, "%d", &threshold) != 1 || threshold <= 0 ||
+            threshold > *getCapacity(park)){
+        printf("invalid threshold.\n");
+    }
+    else{
+        printf("%d\n", subscribePark(eventBus, target, threshold)->id);
+    }
+    free(target);
+}
+
+
+/**
+ * @brief Processes the command showing the notifications of a subscriber.
+ * 
+ * Prints, and removes, every event waiting in the subscriber's buffer, and
+ * how many events were lost because the buffer was full.
+ * 
+ * @param entry_data The input command string containing the subscriber id.
+ */
+void command_n(char entry_data[BUFSIZ]){
+    int id = 0;
+    Event event;
+
+    sscanf(entry_data, "n %d", &id);
+    Subscriber* subscriber = getSubscriber(eventBus, id);
+    if (subscriber == NULL){
+        printf("%d: no such subscriber.\n", id);
+        return;
+    }
+
+    while (popEvent(&subscriber->ring, &event)){
+        printEvent(&event);
+    }
+    unsigned long dropped = takeDropped(&subscriber->ring);
+    if (dropped > 0){
+        printf("%lu events dropped.\n", dropped);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,167 @@
+/**
+ * Implementation of the functions related to the feed merger.
+ *
+ * The lines of several chronological event files are merged through a
+ * loser tree, by the minute of their timestamp.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "command.h"
+#include "lz.h"
+#include "merge.h"
+
+
+/**
+ * @brief Reads the next line of a feed, and the minute it is ordered by.
+ *
+ * @param feed Pointer to the feed.
+ */
+void readFeedLine(MergeFeed* feed){
+    char command;
+    char parkName[PARK_NAME_LENGTH];
+    char plate[PLATE_LENGTH];
+    Timestamp timestamp;
+    int consumed;
+
+    if (fgets(feed->line, sizeof(feed->line), feed->file) == NULL){
+        feed->exhausted = 1;
+        return;
+    }
+    if ((feed->line[0] == 'e' || feed->line[0] == 's') &&
+        parseEntryExit(feed->line, &command, parkName, plate, &timestamp,
+                        &consumed) && validTimestamp(&timestamp)){
+        feed->minute = timestampToMinutes(&timestamp);
+    }
+}
+
+
+/**
+ * @brief Checks if the line of a feed goes before the line of another.
+ *
+ * @param merger Pointer to the feed merger.
+ * @param a Index of the first feed.
+ * @param b Index of the second feed.
+ * @return 1 if the line of feed a goes first, 0 otherwise.
+ */
+int feedBeats(const FeedMerger* merger, unsigned int a, unsigned int b){
+    const MergeFeed* feedA = &merger->feeds[a];
+    const MergeFeed* feedB = &merger->feeds[b];
+
+    if (feedA->exhausted || feedB->exhausted){
+        return !feedA->exhausted;
+    }
+    return feedA->minute < feedB->minute ||
+            (feedA->minute == feedB->minute && a < b);
+}
+
+
+/**
+ * @brief Plays the matches of a subtree of the loser tree.
+ *
+ * Node n has children 2n and 2n + 1, and nodes numFeeds and above are the
+ * leaves, node numFeeds + i being feed i.
+ *
+ * @param merger Pointer to the feed merger.
+ * @param node The root of the subtree.
+ * @return Index of the feed winning the subtree.
+ */
+unsigned int playMatches(FeedMerger* merger, unsigned int node){
+    if (node >= merger->numFeeds){
+        return node - merger->numFeeds;
+    }
+
+    unsigned int left = playMatches(merger, 2 * node);
+    unsigned int right = playMatches(merger, 2 * node + 1);
+    if (feedBeats(merger, left, right)){
+        merger->losers[node] = right;
+        return left;
+    }
+    merger->losers[node] = left;
+    return right;
+}
+
+
+/**
+ * @brief Opens the feeds and reads their first lines.
+ *
+ * @param paths Paths of the event files, each one in chronological order.
+ * @param numPaths Number of paths (1 to MAX_FEEDS).
+ * @return Pointer to the new feed merger, or NULL if a file can't be
+ * opened (the error is printed). Compressed files are decompressed.
+ */
+FeedMerger* newFeedMerger(char* paths[], unsigned int numPaths){
+    FeedMerger* merger = (FeedMerger*)malloc(sizeof(FeedMerger));
+
+    merger->feeds = (MergeFeed*)malloc(numPaths * sizeof(MergeFeed));
+    merger->losers = (unsigned int*)malloc(numPaths * sizeof(unsigned int));
+    for (merger->numFeeds = 0; merger->numFeeds < numPaths;
+            merger->numFeeds++){
+        MergeFeed* feed = &merger->feeds[merger->numFeeds];
+        // Large buffers keep the reads few even with many files open
+        feed->buffer = (char*)malloc(FEED_BUFFER_SIZE);
+        feed->file = openEventFile(paths[merger->numFeeds], feed->buffer,
+                                    FEED_BUFFER_SIZE);
+        if (feed->file == NULL){
+            free(feed->buffer);
+            freeFeedMerger(merger);
+            return NULL;
+        }
+        feed->minute = FEED_START_MINUTE;
+        feed->exhausted = 0;
+        readFeedLine(feed);
+    }
+
+    merger->losers[0] = playMatches(merger, 1);
+    return merger;
+}
+
+
+/**
+ * @brief Closes the feeds and frees the memory allocated for a merger.
+ *
+ * @param merger Pointer to the feed merger.
+ */
+void freeFeedMerger(FeedMerger* merger){
+    for (unsigned int i = 0; i < merger->numFeeds; i++){
+        fclose(merger->feeds[i].file);
+        free(merger->feeds[i].buffer);
+    }
+    free(merger->feeds);
+    free(merger->losers);
+    free(merger);
+}
+
+
+/**
+ * @brief Takes the next line of the merged stream.
+ *
+ * The winning feed reads its next line, which replays the matches on its
+ * path to the root.
+ *
+ * @param merger Pointer to the feed merger.
+ * @param line Where to copy the line.
+ * @return 1 if a line was taken, 0 if every feed is exhausted.
+ */
+int mergeNextLine(FeedMerger* merger, char line[BUFSIZ]){
+    unsigned int winner = merger->losers[0];
+
+    if (merger->feeds[winner].exhausted){
+        return 0;
+    }
+    strcpy(line, merger->feeds[winner].line);
+    readFeedLine(&merger->feeds[winner]);
+
+    for (unsigned int node = (winner + merger->numFeeds) / 2; node > 0;
+            node /= 2){
+        if (feedBeats(merger, merger->losers[node], winner)){
+            unsigned int loser = winner;
+            winner = merger->losers[node];
+            merger->losers[node] = loser;
+        }
+    }
+    merger->losers[0] = winner;
+    return 1;
+}
@@ -0,0 +1,55 @@
+/**
+ * Definition of the feed merger structs, and of the function prototypes
+ * related to them.
+ *
+ * A feed merger reads several event files (feeds), each one already in
+ * chronological order, and gives their lines as a single chronological
+ * stream. It keeps one line of each feed and a loser tree over them: each
+ * internal node holds the feed that lost the match played there, and the
+ * root the overall winner. Taking a line reads the next one of the winning
+ * feed and replays only the matches on its path to the root, so the merge
+ * of k feeds costs log2(k) comparisons per line.
+ *
+ * Lines are ordered by the minute of their timestamp, ties going to the
+ * feed given first. Lines without a valid timestamp (other commands, bad
+ * dates) keep the minute of the line before them in their feed, so they
+ * stay in place relative to it.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef MERGE_H
+#define MERGE_H
+
+#include <stdio.h>
+
+// Maximum number of feeds merged
+#define MAX_FEEDS 64
+// Size of the read buffer of each feed
+#define FEED_BUFFER_SIZE (1 << 20)
+// Minute of the lines before the first timestamp of a feed
+#define FEED_START_MINUTE -1
+
+typedef struct mergeFeed {
+    FILE* file;
+    char* buffer; // read buffer of the file
+    char line[BUFSIZ]; // next line of the feed
+    int minute; // minute of the line
+    int exhausted; // 1 if the feed has no more lines
+} MergeFeed;
+
+typedef struct feedMerger {
+    MergeFeed* feeds;
+    unsigned int numFeeds;
+    unsigned int* losers; // loser of each internal node, [0]: the winner
+} FeedMerger;
+
+
+// Initializer
+FeedMerger* newFeedMerger(char* paths[], unsigned int numPaths);
+
+// Free
+void freeFeedMerger(FeedMerger* merger);
+
+// Merging
+int mergeNextLine(FeedMerger* merger, char line[BUFSIZ]);
+#endif
@@ -0,0 +1,270 @@
+/**
+ * Implementation of the functions related to the output.
+ *
+ * The output writes the responses to entries/exits, vehicle logs and
+ * billings, either as text lines or as binary records.
+ *
+ * Author: Adolfo Monteiro
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include "output.h"
+
+// Text of each error, by error code ('%s' is the subject)
+const char* ERROR_MESSAGES[] = {
+    "%s: no such parking.\n",
+    "%s: parking is full.\n",
+    "%s: invalid licence plate.\n",
+    "%s: invalid vehicle entry.\n",
+    "%s: invalid vehicle exit.\n",
+    "invalid date.\n",
+    "%s: no entries found in any parking.\n"
+};
+
+
+/**
+ * @brief Appends a value to a record.
+ *
+ * @param record Pointer to the end of the record, advanced past the value.
+ * @param value Pointer to the value.
+ * @param size Size of the value, in bytes.
+ */
+void putValue(unsigned char** record, const void* value, unsigned int size){
+    memcpy(*record, value, size);
+    *record += size;
+}
+
+
+/**
+ * @brief Appends a minute count to a record.
+ *
+ * @param record Pointer to the end of the record, advanced past the value.
+ * @param t Pointer to the timestamp, or to INITIAL_TIMESTAMP for 0.
+ */
+void putMinutes(unsigned char** record, const Timestamp* t){
+    unsigned int minutes = isInitialTimestamp(t) ? 0 : timestampToMinutes(t);
+    putValue(record, &minutes, sizeof(minutes));
+}
+
+
+/**
+ * @brief Writes bytes to the stream.
+ *
+ * @param out Pointer to the output.
+ * @param bytes Pointer to the bytes.
+ * @param length Number of bytes.
+ */
+void outputBytes(const Output* out, const void* bytes, unsigned long length){
+    fwrite(bytes, 1, length, out->stream);
+}
+
+
+/**
+ * @brief Adds bytes to a digest (write function of a digest stream).
+ *
+ * @param cookie Pointer to the digest.
+ * @param buffer The bytes.
+ * @param size Number of bytes.
+ * @return Number of bytes hashed.
+ */
+ssize_t writeDigested(void* cookie, const char* buffer, size_t size){
+    digestUpdate((Digest*)cookie, buffer, size);
+    return (ssize_t)size;
+}
+
+
+/**
+ * @brief Opens a stream that hashes the bytes written to it into a digest,
+ * instead of writing them.
+ *
+ * The stream is buffered, so the digest is only up to date after it is
+ * flushed or closed.
+ *
+ * @param digest Pointer to the digest, already initialized.
+ * @return The stream.
+ */
+FILE* openDigestStream(Digest* digest){
+    cookie_io_functions_t functions = {NULL, writeDigested, NULL, NULL};
+
+    return fopencookie(digest, "w", functions);
+}
+
+
+/**
+ * @brief Writes a record, followed by a length prefixed string.
+ *
+ * @param out Pointer to the output.
+ * @param record The fixed part of the record.
+ * @param end Pointer to the end of the fixed part.
+ * @param str The string, or NULL if the record has none.
+ */
+void writeRecord(const Output* out, unsigned char* record, unsigned char* end,
+const char* str){
+    if (str != NULL){
+        unsigned short length = (unsigned short)strlen(str);
+        putValue(&end, &length, sizeof(length));
+        outputBytes(out, record, end - record);
+        outputBytes(out, str, length);
+        return;
+    }
+    outputBytes(out, record, end - record);
+}
+
+
+/**
+ * @brief Writes the response to an entry.
+ *
+ * @param out Pointer to the output.
+ * @param parkName The name of the park.
+ * @param availableSpots The available spots left in the park.
+ */
+void outputEntry(const Output* out, const char* parkName, int availableSpots){
+    if (!out->binary){
+        fprintf(out->stream, "%s %d\n", parkName, availableSpots);
+        return;
+    }
+    unsigned char record[RECORD_MAX_LENGTH], *end = record;
+    unsigned int spots = availableSpots;
+
+    *end++ = RECORD_ENTRY;
+    putValue(&end, &spots, sizeof(spots));
+    writeRecord(out, record, end, parkName);
+}
+
+
+/**
+ * @brief Writes the response to an exit.
+ *
+ * @param out Pointer to the output.
+ * @param log The log of the stay, which must have an exit.
+ * @param cost The cost of the stay.
+ */
+void outputExit(const Output* out, Log* log, double cost){
+    if (!out->binary){
+        fprintf(out->stream, "%s ", getLogPlate(log));
+        fprintTimestamp(out->stream, getEntryTimestamp(log));
+        fprintf(out->stream, " ");
+        fprintTimestamp(out->stream, getExitTimestamp(log));
+        fprintf(out->stream, " %.2f\n", cost);
+        return;
+    }
+    unsigned char record[RECORD_MAX_LENGTH], *end = record;
+    unsigned int packed = packPlate(getLogPlate(log));
+
+    *end++ = RECORD_EXIT;
+    putValue(&end, &packed, sizeof(packed));
+    putMinutes(&end, getEntryTimestamp(log));
+    putMinutes(&end, getExitTimestamp(log));
+    putValue(&end, &cost, sizeof(cost));
+    writeRecord(out, record, end, NULL);
+}
+
+
+/**
+ * @brief Writes one of the stays listed for a vehicle.
+ *
+ * @param out Pointer to the output.
+ * @param log The log of the stay.
+ */
+void outputVisit(const Output* out, Log* log){
+    if (!out->binary){
+        fprintf(out->stream, "%s ", getLogParkName(log));
+        fprintTimestamp(out->stream, getEntryTimestamp(log));
+        // If an exit exists, print its timestamp
+        if (!isInitialTimestamp(getExitTimestamp(log))){
+            fprintf(out->stream, " ");
+            fprintTimestamp(out->stream, getExitTimestamp(log));
+        }
+        fprintf(out->stream, "\n");
+        return;
+    }
+    unsigned char record[RECORD_MAX_LENGTH], *end = record;
+
+    *end++ = RECORD_VISIT;
+    putMinutes(&end, getEntryTimestamp(log));
+    putMinutes(&end, getExitTimestamp(log));
+    writeRecord(out, record, end, getLogParkName(log));
+}
+
+
+/**
+ * @brief Writes one of the exits listed in a day's billing.
+ *
+ * @param out Pointer to the output.
+ * @param log The log of the stay, which must have an exit.
+ * @param cost The cost of the stay.
+ */
+void outputBill(const Output* out, Log* log, double cost){
+    if (!out->binary){
+        fprintf(out->stream, "%s ", getLogPlate(log));
+        fprintHourMinutes(out->stream, getExitTimestamp(log));
+        fprintf(out->stream, " %.2f\n", cost);
+        return;
+    }
+    unsigned char record[RECORD_MAX_LENGTH], *end = record;
+    unsigned int packed = packPlate(getLogPlate(log));
+
+    *end++ = RECORD_BILL;
+    putValue(&end, &packed, sizeof(packed));
+    putMinutes(&end, getExitTimestamp(log));
+    putValue(&end, &cost, sizeof(cost));
+    writeRecord(out, record, end, NULL);
+}
+
+
+/**
+ * @brief Writes the total billed in a day.
+ *
+ * @param out Pointer to the output.
+ * @param day Pointer to the timestamp of the day.
+ * @param bill The total billed in the day.
+ */
+void outputDayBill(const Output* out, const Timestamp* day, double bill){
+    if (!out->binary){
+        fprintDate(out->stream, day);
+        fprintf(out->stream, " %.2f\n", bill);
+        return;
+    }
+    unsigned char record[RECORD_MAX_LENGTH], *end = record;
+    Timestamp midnight = newTimestamp(day->day, day->month, day->year, 0, 0);
+
+    *end++ = RECORD_DAY_BILL;
+    putMinutes(&end, &midnight);
+    putValue(&end, &bill, sizeof(bill));
+    writeRecord(out, record, end, NULL);
+}
+
+
+/**
+ * @brief Writes an error.
+ *
+ * @param out Pointer to the output.
+ * @param code The error code (ERROR_*).
+ * @param subject The park name or plate the error is about ("" if none).
+ */
+void outputError(const Output* out, int code, const char* subject){
+    if (!out->binary){
+        fprintf(out->stream, ERROR_MESSAGES[code], subject);
+        return;
+    }
+    unsigned char record[RECORD_MAX_LENGTH], *end = record;
+
+    *end++ = RECORD_ERROR;
+    *end++ = (unsigned char)code;
+    writeRecord(out, record, end, subject);
+}
+
+
+/**
+ * @brief Ends a list of visits or bills (only binary records need it).
+ *
+ * @param out Pointer to the output.
+ */
+void outputEnd(const Output* out){
+    unsigned char end = RECORD_END;
+
+    if (out->binary){
+        outputBytes(out, &end, sizeof(end));
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * Definition of the output struct, and of the function prototypes related
+ * to it.
+ *
+ * The output writes the responses to entries/exits ('e', 's'), vehicle
+ * logs ('v') and billings ('f'), either as the specified text lines or as
+ * compact binary records for machine clients. Binary records are written
+ * straight from the internal values (packed plates, minutes, doubles), in
+ * the byte order of the host and without padding:
+ *
+ *   entry:    'E' u32 availableSpots u16 nameLength name
+ *   exit:     'S' u32 packedPlate u32 entryMinute u32 exitMinute f64 cost
+ *   visit:    'V' u32 entryMinute u32 exitMinute u16 nameLength name
+ *   bill:     'B' u32 packedPlate u32 exitMinute f64 cost
+ *   day bill: 'D' u32 dayMinute f64 bill
+ *   error:    '!' u8 errorCode u16 subjectLength subject
+ *   end:      '.' (after the last visit or bill of a command)
+ *
+ * Minutes are counted as in timestampToMinutes, and an exitMinute of 0
+ * means the vehicle is still inside. Other commands always answer in text.
+ *
+ * A digest stream (openDigestStream) hashes what is written to it instead
+ * of writing it (see digest.h). Installed as stdout, it takes the binary
+ * records and the text answers of every other command, in order, to
+ * measure the engine without the cost of the output.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include "digest.h"
+#include "log.h"
+
+// Record types
+#define RECORD_ENTRY 'E'
+#define RECORD_EXIT 'S'
+#define RECORD_VISIT 'V'
+#define RECORD_BILL 'B'
+#define RECORD_DAY_BILL 'D'
+#define RECORD_ERROR '!'
+#define RECORD_END '.'
+// Maximum length of the fixed part of a record
+#define RECORD_MAX_LENGTH 32
+
+// Error codes (index of the text message)
+#define ERROR_NO_SUCH_PARKING 0
+#define ERROR_PARKING_FULL 1
+#define ERROR_INVALID_PLATE 2
+#define ERROR_INVALID_ENTRY 3
+#define ERROR_INVALID_EXIT 4
+#define ERROR_INVALID_DATE 5
+#define ERROR_NO_ENTRIES 6
+
+typedef struct output {
+    int binary; // 1 for binary records, 0 for text
+    FILE* stream;
+} Output;
+
+
+// Raw bytes
+void outputBytes(const Output* out, const void* bytes, unsigned long length);
+FILE* openDigestStream(Digest* digest);
+
+// Responses
+void outputEntry(const Output* out, const char* parkName, int availableSpots);
+void outputExit(const Output* out, Log* log, double cost);
+void outputVisit(const Output* out, Log* log);
+void outputBill(const Output* out, Log* log, double cost);
+void outputDayBill(const Output* out, const Timestamp* day, double bill);
+void outputError(const Output* out, int code, const char* subject);
+void outputEnd(const Output* out);
+#endif
@@ -11,9 +11,6 @@
 #include <string.h>
 #include "park.h"
 
-// Maximum number of parks in the system
-#define MAX_PARKS 20
-
 
 /**
  * @brief Creates a new park node.
@@ -23,7 +20,7 @@
  * 
  * @param name Name of the park.
  * @param capacity Pointer to the capacity of the park.
- * @param tariff Pointer to the tariff of the park.
+ * @param tariff Pointer to the tariff of the park (the park takes its tables).
  * @return Pointer to the newly created park node.
  */
 Park *newPark(char *name, const int* capacity, const Tariff* tariff){
@@ -36,6 +33,19 @@ Park *newPark(char *name, const int* capacity, const Tariff* tariff){
     newParkNode->tariff = *tariff;
 
     newParkNode->logTable = newHashtable();
+    initLogPool(&newParkNode->logPool);
+    openLogMapInit(&newParkNode->openLogs);
+    newParkNode->visitors = newBitmap();
+    newParkNode->occupants = newBitmap();
+    newParkNode->days = newParkDays();
+    newParkNode->exits = newExitTree();
+    newParkNode->bucket = NULL;
+    newParkNode->prevAvailable = NULL;
+    newParkNode->nextAvailable = NULL;
+    newParkNode->groups = NULL;
+    newParkNode->numGroups = 0;
+    newParkNode->revenue = 0;
+    newParkNode->passes = NULL;
     newParkNode->next = NULL;
 
     return newParkNode;
@@ -53,10 +63,47 @@ Park *newPark(char *name, const int* capacity, const Tariff* tariff){
 void freePark(Park *park){
     free(park->name);
     freeHashtable(park->logTable);
+    freeLogPool(&park->logPool);
+    openLogMapFree(&park->openLogs);
+    freeBitmap(park->visitors);
+    freeBitmap(park->occupants);
+    freeParkDays(park->days);
+    freeExitTree(park->exits);
+    free(park->groups);
+    freePassSet(park->passes);
+    freeTariff(&park->tariff);
     free(park);
 }
 
 
+/**
+ * @brief Stores the parks of a linked list in an array, in list order.
+ * 
+ * @param headPark Pointer to the head of the park linked list.
+ * @param parks Where to store the parks (MAX_PARKS long).
+ * @return The number of parks.
+ */
+unsigned int listParks(Park *headPark, Park* parks[MAX_PARKS]){
+    unsigned int numParks = 0;
+
+    for (; headPark != NULL; headPark = headPark->next){
+        parks[numParks++] = headPark;
+    }
+    return numParks;
+}
+
+
+/**
+ * @brief Frees one park of an array (body of a parallel for).
+ * 
+ * @param parks The array of parks.
+ * @param i Index of the park to free.
+ */
+void freeParkAt(void* parks, unsigned int i){
+    freePark(((Park**)parks)[i]);
+}
+
+
 /**
  * @brief Frees memory allocated for all park nodes in the linked list.
  * 
@@ -64,13 +111,14 @@ void freePark(Park *park){
  * list, including their names and log tables.
  * 
  * @param headPark Pointer to the head of the park linked list.
+ * @param scheduler Pointer to the scheduler running the job.
  */
-void freeAllParks(Park *headPark){
-    while (headPark != NULL){
-        Park *nextPark = headPark->next;
-        freePark(headPark);
-        headPark = nextPark;
-    }
+void freeAllParks(Park *headPark, Scheduler* scheduler){
+    Park* parks[MAX_PARKS];
+    unsigned int numParks = listParks(headPark, parks);
+
+    // Parks share no memory, so they can be freed in parallel
+    parallelFor(scheduler, 0, numParks, 1, freeParkAt, parks);
 }
 
 
@@ -161,73 +209,237 @@ Park *findLastPark(Park *headPark){
 
 
 /**
- * @brief Retrieves a park with the specified name from the linked list
- * of parks.
+ * @brief Retrieves a park with the specified name from the index of parks.
  * 
- * @param headPark Pointer to the head of the park linked list.
+ * @param parkIndex Pointer to the map from park name to park.
  * @param parkName Name of the park to retrieve.
  * @return Pointer to the park with the specified name if found, otherwise NULL
  */
-Park *getPark(Park *headPark, const char *parkName){
-    // Transverse the linked list, looking for the park with name parkName
-    while (headPark != NULL){
-        if (strcmp(parkName, getParkName(headPark)) == 0){
-            return headPark;
+Park *getPark(const ParkMap *parkIndex, const char *parkName){
+    Park **park = parkMapFind(parkIndex, parkName);
+
+    return park != NULL ? *park : NULL;
+}
+
+
+/**
+ * @brief Copies the logs of a plate in one park of a PlateLogsJob (body of
+ * a parallel for).
+ * 
+ * @param plateLogsJob Pointer to the PlateLogsJob.
+ * @param i Index of the park.
+ */
+void collectPlateLogs(void* plateLogsJob, unsigned int i){
+    PlateLogsJob* job = (PlateLogsJob*)plateLogsJob;
+    Park* park = job->parks[i];
+    Log** tail = &job->logs[i];
+
+    // Get the logs stored at the same hashtable's index as plate
+    Log* currentLog = getLogAtIndex(getTable(park),
+        plateHash(job->plate, getSize(getTable(park))));
+
+    // Transverse the logs, looking for log's with the correct plate
+    *tail = NULL;
+    for (; currentLog != NULL; currentLog = currentLog->next){
+        if (strcmp(getLogPlate(currentLog), job->plate) == 0) {
+            // If the currentLog's plate is the plate we're looking for,
+            // add it to the park's logs
+            *tail = newLog(job->plate, getParkName(park));
+            copyLogTimestamps(*tail, currentLog);
+            tail = &(*tail)->next;
         }
-        headPark = headPark->next;
     }
-
-    return NULL;
 }
 
 
 /**
  * @brief Retrieves all logs associated with a specific plate across all parks.
  * 
+ * Each park is searched in parallel, and the logs are joined in park order.
+ * 
  * @param headPark Pointer to the head of the park linked list.
  * @param plate The license plate to retrieve logs for.
+ * @param scheduler Pointer to the scheduler running the job.
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
  * @return Pointer to the linked list of logs associated with the given plate.
  *         The logs are sorted first by park name and then by entry timestamp,
  * both in ascending order.
  */
-Log *getPlateLogs(Park *headPark, const char plate[PLATE_LENGTH]){
+Log *getPlateLogs(Park *headPark, const char plate[PLATE_LENGTH],
+Scheduler* scheduler, Tracer* tracer){
     Log *plateLogs = NULL;
+    PlateLogsJob job;
+
+    job.plate = plate;
+    unsigned int numParks = listParks(headPark, job.parks);
+    SpanStart start = traceBegin(tracer);
+    parallelFor(scheduler, 0, numParks, 1, collectPlateLogs, &job);
+    traceEnd(tracer, "collect logs", &start);
+
+    for (unsigned int i = 0; i < numParks; i++){
+        addLogtoLog(&plateLogs, job.logs[i]);
+    }
+
+    mergeSort(&plateLogs, 'e', scheduler, tracer);
+    return plateLogs; 
+}
+
+
+/**
+ * @brief Retrieves the set of plate ids that ever entered a park.
+ * 
+ * @param park Pointer to the park.
+ * @return Pointer to the bitmap of visitor plate ids.
+ */
+Bitmap* getVisitors(const Park* park){
+    return park->visitors;
+}
+
+
+/**
+ * @brief Retrieves the set of plate ids currently inside a park.
+ * 
+ * @param park Pointer to the park.
+ * @return Pointer to the bitmap of occupant plate ids.
+ */
+Bitmap* getOccupants(const Park* park){
+    return park->occupants;
+}
+
+
+/**
+ * @brief Retrieves the daily statistics of a park.
+ * 
+ * @param park Pointer to the park.
+ * @return Pointer to the park's days, sorted by date.
+ */
+ParkDays* getParkDays(const Park* park){
+    return park->days;
+}
+
+
+/**
+ * @brief Retrieves the passes valid only in a park.
+ * 
+ * @param park Pointer to the park.
+ * @return Pointer to the park's pass set, or NULL if it has no passes.
+ */
+PassSet* getParkPasses(const Park* park){
+    return park->passes;
+}
+
+
+/**
+ * @brief Adds a pass valid only in a park, creating its pass set if it's
+ * the first.
+ * 
+ * @param park Pointer to the park.
+ * @param plate The license plate of the holder.
+ * @param firstDay Pointer to the first day the pass is valid.
+ * @param lastDay Pointer to the last day the pass is valid.
+ */
+void addParkPass(Park* park, const char plate[PLATE_LENGTH],
+const Timestamp* firstDay, const Timestamp* lastDay){
+    if (park->passes == NULL){
+        park->passes = newPassSet();
+    }
+    addPass(park->passes, plate, firstDay, lastDay);
+}
+
+
+/**
+ * @brief Retrieves the number of exits registered in a park.
+ * 
+ * @param park Pointer to the park.
+ * @return The number of exits.
+ */
+unsigned int getNumExits(const Park* park){
+    return getExitTreeSize(park->exits);
+}
+
+
+/**
+ * @brief Retrieves the log of an exit, exits being sorted by their
+ * timestamp.
+ * 
+ * @param park Pointer to the park.
+ * @param index Position of the exit.
+ * @return Pointer to the log of the exit.
+ */
+Log* getExitAtIndex(const Park* park, unsigned int index){
+    return getExitTreeLogAt(park->exits, index);
+}
+
+
+/**
+ * @brief Retrieves the log of the exit after another, exits being sorted by
+ * their timestamp.
+ * 
+ * @param park Pointer to the park.
+ * @param log Pointer to the log of an exit of the park.
+ * @return Pointer to the log of the next exit, or NULL if it's the last.
+ */
+Log* getNextExit(const Park* park, const Log* log){
+    return getExitTreeNextLog(park->exits, log);
+}
+
+
+/**
+ * @brief Finds the first exit of a park not before the given day.
+ * 
+ * @param park Pointer to the park.
+ * @param date Pointer to the timestamp of the day.
+ * @return Position of the exit, or getNumExits if there is none.
+ */
+unsigned int findFirstExit(const Park* park, const Timestamp* date){
+    return countExitsBefore(park->exits, date);
+}
+
+
+/**
+ * @brief Finds the first exit of a park after the given day.
+ * 
+ * @param park Pointer to the park.
+ * @param date Pointer to the timestamp of the day.
+ * @return Position of the exit, or getNumExits if there is none.
+ */
+unsigned int findExitAfter(const Park* park, const Timestamp* date){
+    return countExitsUntil(park->exits, date);
+}
+
+
+/**
+ * @brief Computes the set of plate ids currently inside any park.
+ * 
+ * @param headPark Pointer to the head of the park linked list.
+ * @return Pointer to a new bitmap (to be freed by the caller) with the union
+ * of the occupants of every park.
+ */
+Bitmap* occupantsOfAllParks(Park* headPark){
+    Bitmap* occupants = newBitmap();
 
-    // Transverse the parks
     while (headPark != NULL){
-        // Get the logs stored at the same hashtable's index as plate
-        Log* currentLog = getLogAtIndex(getTable(headPark),
-            plateHash(plate, getSize(getTable(headPark))));
-
-        // Transverse the logs, looking for log's with the correct plate
-        while (currentLog != NULL) {
-            if (strcmp(getLogPlate(currentLog), plate) == 0) {
-                // If the currentLog's plate is the plate we're looking for,
-                // add it to plateLogs
-                Log *newLogAux = newLog(plate, getParkName(headPark));
-                copyLogTimestamps(newLogAux, currentLog);
-                addLogtoLog(&plateLogs, newLogAux);
-            }
-            currentLog = currentLog->next;
-        }
+        Bitmap* merged = bitmapOr(occupants, getOccupants(headPark));
+        freeBitmap(occupants);
+        occupants = merged;
         headPark = headPark->next;
     }
 
-    mergeSort(&plateLogs, 'e');
-    return plateLogs; 
+    return occupants;
 }
 
 
 /**
- * @brief Removes a park from the linked list of parks.
+ * @brief Removes a park from the linked list and the index of parks.
  * 
  * @param headPark Pointer to the pointer to the head of the park linked list.
+ * @param parkIndex Pointer to the map from park name to park.
  * @param parkName Name of the park to be removed.
  * @return 1 if the park is successfully removed, 0 otherwise.
  */
-int removePark(Park **headPark, const char *parkName){
+int removePark(Park **headPark, ParkMap *parkIndex, const char *parkName){
     // Park to remove doesn't exist
-    if (getPark(*headPark, parkName) == NULL){
+    if (!parkMapRemove(parkIndex, parkName)){
         printf("%s: no such parking.\n", parkName);
         return 0;
     }
@@ -264,18 +476,19 @@ int removePark(Park **headPark, const char *parkName){
  * been reached, and if so adds the park to the end of the linked list of parks
  * 
  * @param headPark Pointer to the pointer to the head of the park linked list.
+ * @param parkIndex Pointer to the map from park name to park.
  * @param park Pointer to the park to be added.
  * @return 1 if the park is successfully added, 0 otherwise.
  */
-int addPark(Park **headPark, Park *park){
-    if (getPark(*headPark, park->name) != NULL){
+int addPark(Park **headPark, ParkMap *parkIndex, Park *park){
+    if (getPark(parkIndex, park->name) != NULL){
         printf("%s: parking already exists.\n", park->name);
         return 0;
     }
     
     int isCapacityValid = (*getCapacity(park) > 0);
     int isTariffValid = validTariff(getTariff(park));
-    int isMaxParksReached = totalParks(*headPark) >= MAX_PARKS;
+    int isMaxParksReached = parkIndex->numEntries >= MAX_PARKS;
 
     // If the park is not valid or if the maximum number of parks has been
     // reached, display the appropriate error message
@@ -295,6 +508,7 @@ int addPark(Park **headPark, Park *park){
     else{ // Otherwise add it in the end of the list
         findLastPark(*headPark)->next = park;
     }
+    parkMapPut(parkIndex, park->name, park);
 
     return 1;
 }
@@ -363,36 +577,176 @@ void printParksAlphabetically(Park *headPark){
 }
 
 
+/**
+ * @brief Retrieves the log of the vehicle currently inside a park.
+ * 
+ * @param park Pointer to the park.
+ * @param plateId The id of the vehicle's plate.
+ * @return Pointer to the log of the vehicle's stay without an exit, or NULL
+ * if the vehicle is not inside the park.
+ */
+Log* getOpenLog(const Park* park, unsigned int plateId){
+    Log** log = openLogMapFind(&park->openLogs, plateId);
+
+    return log != NULL ? *log : NULL;
+}
+
+
+/**
+ * @brief Sets the log of the vehicle currently inside a park.
+ * 
+ * Only the vehicles inside are mapped, so the map is sized by the park's
+ * occupancy, not by the number of plates ever seen.
+ * 
+ * @param park Pointer to the park.
+ * @param plateId The id of the vehicle's plate.
+ * @param log Pointer to the log without an exit, or NULL once it exits.
+ */
+void setOpenLog(Park* park, unsigned int plateId, Log* log){
+    if (log == NULL){
+        openLogMapRemove(&park->openLogs, plateId);
+        return;
+    }
+    openLogMapPut(&park->openLogs, plateId, log);
+}
+
+
 /**
  * @brief Checks if a given plate is present in a specific park.
  * 
  * @param park Pointer to the park to check.
- * @param plate The license plate to search for.
+ * @param plateId The id of the license plate to search for.
  * @return 1 if the plate is currently inside the park, 0 otherwise
  */
-int plateInPark(const Park *park, const char plate[PLATE_LENGTH]){
+int plateInPark(const Park *park, unsigned int plateId){
     // It's in the park if it has an entry (therefore has a log) but
     // no corresponding exit
-    return getPlateLastLogWithoutExit(getTable(park), plate) != NULL;
+    return getOpenLog(park, plateId) != NULL;
 }
 
 
 /**
- * @brief Checks if a given plate is inside any park of the linked list.
+ * @brief Looks up everything an entry/exit needs, once: the park, the
+ * plate's id and its stay in progress in the park.
  * 
- * @param headPark Pointer to the head of the park linked list.
- * @param plate The license plate to search for.
- * @return 1 if the plate is currently inside any park, 0 otherwise
+ * The plate is only looked up if the park exists and the plate is valid.
+ * 
+ * @param parkIndex Pointer to the map from park name to park.
+ * @param dict Pointer to the plate dictionary.
+ * @param parkName The name of the park.
+ * @param plate The license plate of the vehicle.
+ * @return The handle of the entry/exit.
  */
-int plateInAnyPark(Park *headPark, const char plate[PLATE_LENGTH]){
-    // It is in any park if it is in one of the parks
-    while (headPark != NULL){
-        if (plateInPark(headPark, plate)){
-            return 1;
+EntryExitHandle findEntryExit(const ParkMap* parkIndex, const PlateDict* dict,
+const char* parkName, const char plate[PLATE_LENGTH]){
+    EntryExitHandle handle = {getPark(parkIndex, parkName), NO_PLATE_ID,
+                                NULL, 0};
+
+    if (handle.park != NULL && validPlate(plate)){
+        handle.plateId = findPlateId(dict, plate);
+        handle.openLog = getOpenLog(handle.park, handle.plateId);
+        handle.parksInside = getParksInside(dict, handle.plateId);
+    }
+    return handle;
+}
+
+
+/**
+ * @brief Calculates the cost of a finished stay.
+ * 
+ * The stay is free if the vehicle has a pass valid on the day of the exit,
+ * either a global one or one of the park. Vehicles without passes only pay
+ * for a lookup in the (usually empty) bitmaps of holders.
+ * 
+ * @param park Pointer to the park of the stay.
+ * @param passes Pointer to the global pass set.
+ * @param log Pointer to the log of the stay.
+ * @return The cost of the stay.
+ */
+double calculateStayCost(Park* park, const PassSet* passes, Log* log){
+    unsigned int packedPlate = packPlate(getLogPlate(log));
+    Timestamp* exit = getExitTimestamp(log);
+
+    if (hasPass(passes, packedPlate, exit) ||
+        hasPass(getParkPasses(park), packedPlate, exit)){
+        return 0;
+    }
+    return calculateParkingCost(getTariff(park), getEntryTimestamp(log), exit);
+}
+
+
+/**
+ * @brief Registers a validated entry/exit from its handle.
+ * 
+ * A plate seen for the first time is interned, and the dictionary's count
+ * of the parks the plate is inside, its chain of the plate's visits and the
+ * availability index are updated.
+ * 
+ * @param handle Pointer to the handle from findEntryExit.
+ * @param dict Pointer to the plate dictionary.
+ * @param availability Pointer to the availability index.
+ * @param passes Pointer to the global pass set.
+ * @param plate The license plate of the vehicle.
+ * @param timestamp Pointer to the timestamp of the entry or exit.
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
+ * @return Pointer to the log of the registered entry or exit.
+ */
+Log* applyEntryExit(EntryExitHandle* handle, PlateDict* dict,
+AvailabilityIndex* availability, const PassSet* passes,
+const char plate[PLATE_LENGTH], const Timestamp* timestamp, Tracer* tracer){
+    if (handle->plateId == NO_PLATE_ID){
+        SpanStart probe = traceBegin(tracer);
+        handle->plateId = internPlate(dict, plate);
+        traceEnd(tracer, "hash probe", &probe);
+    }
+
+    addParksInside(dict, handle->plateId, handle->openLog != NULL ? -1 : 1);
+    Log* log = registerEntryExit(handle->park, passes, plate,
+                        handle->plateId, handle->openLog, timestamp, tracer);
+    if (handle->openLog == NULL){
+        addPlateVisit(dict, handle->plateId, log);
+    }
+    updateAvailability(availability, handle->park,
+                        *getAvailableSpots(handle->park));
+    return log;
+}
+
+
+/**
+ * @brief Marks the plates inside a park as having left it, before the park
+ * is removed.
+ * 
+ * @param park Pointer to the park.
+ * @param dict Pointer to the plate dictionary.
+ */
+void releaseOccupants(const Park* park, PlateDict* dict){
+    unsigned int n = bitmapCardinality(getOccupants(park));
+    unsigned int* ids = (unsigned int*)malloc(n * sizeof(unsigned int) + 1);
+
+    bitmapToArray(getOccupants(park), ids);
+    for (unsigned int i = 0; i < n; i++){
+        addParksInside(dict, ids[i], -1);
+    }
+    free(ids);
+}
+
+
+/**
+ * @brief Takes the visits of a park out of their plates' chains, before the
+ * park is removed.
+ * 
+ * @param park Pointer to the park.
+ * @param dict Pointer to the plate dictionary.
+ */
+void releaseVisits(const Park* park, PlateDict* dict){
+    Hashtable* table = getTable(park);
+
+    for (int i = 0; i < getSize(table); i++){
+        Log* log = getLogAtIndex(table, i);
+        for (; log != NULL; log = log->next){
+            removePlateVisit(dict, findPlateId(dict, getLogPlate(log)), log);
         }
-        headPark = headPark->next;
     }
-    return 0;
 }
 
 
@@ -400,98 +754,200 @@ int plateInAnyPark(Park *headPark, const char plate[PLATE_LENGTH]){
  * @brief Registers the entry or exit of a vehicle with the given plate
  * in the specified park.
  * 
+ * Nothing is printed: the caller answers the command from the returned log.
+ * 
  * @param park Pointer to the park where the entry or exit is being registered.
+ * @param passes Pointer to the global pass set.
  * @param plate The license plate of the vehicle.
+ * @param plateId The id of the license plate in the plate dictionary.
+ * @param plateLastLog The vehicle's stay in progress in the park (see
+ * getOpenLog): if there's one, this is an exit, otherwise an entry.
  * @param timestamp Pointer to the timestamp of the entry or exit.
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
+ * @return Pointer to the log of the registered entry or exit.
  */
-void registerEntryExit(Park *park, const char plate[PLATE_LENGTH],
-const Timestamp* timestamp){
+Log* registerEntryExit(Park *park, const PassSet* passes,
+const char plate[PLATE_LENGTH], unsigned int plateId, Log* plateLastLog,
+const Timestamp* timestamp, Tracer* tracer){
     int* availableSpots = getAvailableSpots(park);
 
-    if (plateInPark(park, plate)){
+    if (plateLastLog != NULL){
         // If the plate is already in the park, we're adding it's exit
         (*availableSpots)++;
-        // Find the plate's latest entry log in the park
-        Log* plateLastLog = getPlateLastLogWithoutExit(getTable(park), plate);
+        setOpenLog(park, plateId, NULL);
+        bitmapRemove(getOccupants(park), plateId);
 
         // Set the plate's latest log's exit to the given timestamp
         Timestamp* exitTimestamp = getExitTimestamp(plateLastLog);
         copyTimestamp(exitTimestamp, timestamp);
+        plateLastLog->cost = calculateStayCost(park, passes, plateLastLog);
+        addExitToTree(park->exits, plateLastLog);
 
-        // Display the exit message
-        printPlate(plate);
-        printf(" ");
-        printTimestamp(getEntryTimestamp(plateLastLog));
-        printf(" ");
-        printTimestamp(exitTimestamp);
-        printf(" %.2f\n", calculateParkingCost(getTariff(park),
-                            getEntryTimestamp(plateLastLog), exitTimestamp));
-        return;
+        return plateLastLog;
     }
 
     // We're adding an entry
     (*availableSpots)--;
-    Log *newLogEntry = newLog(plate, getParkName(park));
+    Log *newLogEntry = poolLog(&park->logPool, plate, getParkName(park));
     copyTimestamp(getEntryTimestamp(newLogEntry), timestamp);
-    addLogToTable(getTable(park), newLogEntry);
-    printf("%s %d\n", getParkName(park), *availableSpots);
-}
-
-
-/**
- * @brief Displays the billing information for the park based on the
- * given timestamp.
- * 
- * @param park Pointer to the park for which to display billing information.
- * @param timestamp Pointer to the timestamp used to filter billing information
- * 
- * If the timestamp is the INITIAL_TIMESTAMP it means that no date was
- * specified on the 'f' command and therefore displays all the daily park
- * billing since creation. Otherwise, if a timestamp was specified, displays
- * the park billing for the specified day in the timestamp (i.e. billing for
- * each exit in that day).
- */
-void showParkBilling(Park *park, const Timestamp* timestamp){
-    Log *currentLog = NULL;
-    Log *exitLog = NULL; // head of the linked list to store exit logs
-    Log *newLogEntry = NULL; // helper to build the linked list
-    Timestamp* exitTimestamp;
-
-    Hashtable* ht = getTable(park);
-    unsigned int tableSize = getSize(ht);
-
-    for (unsigned int i = 0; i < tableSize; i++){
-        currentLog = getLogAtIndex(ht, i);
-        // Transverse the park logs (entries & exits)
-        while (currentLog != NULL) {
-            exitTimestamp = getExitTimestamp(currentLog);
-            // Verify if the log is of interest to be displayed
-            if (!isInitialTimestamp(exitTimestamp) && // Must be an exit
-                // If the input timestamp is INITIAL_TIMESTAMP we retrieve all
-                // logs with an exit
-                (isInitialTimestamp(timestamp) ||
-                // Otherwise, retrieve the logs with the specified exit date
-                    compareDate(exitTimestamp, timestamp) == 0)){
-                // Build up a Log linked list with the exit logs of interest        
-                newLogEntry = newLog(getLogPlate(currentLog), getParkName(park));
-                copyLogTimestamps(newLogEntry, currentLog);
-                addLogtoLog(&exitLog, newLogEntry);
+    addLogToTable(getTable(park), newLogEntry, tracer);
+    setOpenLog(park, plateId, newLogEntry);
+    bitmapAdd(getVisitors(park), plateId);
+    bitmapAdd(getOccupants(park), plateId);
+    hllAdd(&getParkDay(getParkDays(park), timestamp)->visitors,
+            hllHash(packPlate(plate)));
+    return newLogEntry;
+}
+
+
+/**
+ * @brief Checks if another visit overlaps a visit, with the given exit.
+ * 
+ * @param log Pointer to the log of the other visit.
+ * @param visit Pointer to the log of the visit.
+ * @param exit Pointer to the exit timestamp of the visit.
+ * @return 1 if the other visit overlaps the visit, 0 otherwise.
+ */
+int visitsOverlap(Log* log, Log* visit, const Timestamp* exit){
+    // Entered before the exit, and left after the entry (or not yet)
+    return compareTimestamps(getEntryTimestamp(log), exit) < 0 &&
+            (isInitialTimestamp(getExitTimestamp(log)) ||
+            compareTimestamps(getExitTimestamp(log),
+                                getEntryTimestamp(visit)) > 0);
+}
+
+
+/**
+ * @brief Checks if a visit, with the given exit, would overlap another
+ * visit of the same vehicle, in any park.
+ * 
+ * The plate's visits are chained by entry (see addPlateVisit), so only the
+ * later ones entering before the exit are checked: the next one, and any
+ * visits that entered and left at the minute of the visit's entry. The
+ * earlier ones all left by the visit's entry, unless the plate ever had
+ * overlapping visits: then they're all checked too.
+ * 
+ * @param dict Pointer to the plate dictionary.
+ * @param visit Pointer to the log of the visit.
+ * @param exit Pointer to the exit timestamp of the visit.
+ * @return 1 if the vehicle was in a park during the visit, 0 otherwise.
+ */
+int visitOverlaps(const PlateDict* dict, Log* visit, const Timestamp* exit){
+    Log* log = visit->nextVisit;
+
+    for (; log != NULL; log = log->nextVisit){
+        if (compareTimestamps(getEntryTimestamp(log), exit) >= 0){
+            break;
+        }
+        if (visitsOverlap(log, visit, exit)){
+            return 1;
+        }
+    }
+
+    if (plateVisitsOverlap(dict, findPlateId(dict, getLogPlate(visit)))){
+        for (log = visit->prevVisit; log != NULL; log = log->prevVisit){
+            if (visitsOverlap(log, visit, exit)){
+                return 1;
             }
-            currentLog = currentLog->next;
         }
     }
+    return 0;
+}
 
-    // Sort the logs according to the exit timestamp
-    mergeSort(&exitLog, 's');
 
-    Tariff* parkTariff = getTariff(park);
-    if (!isInitialTimestamp(timestamp)) {
-        // Print bills for the specified day
-        printDailyBillLog(exitLog, parkTariff);
-    } else {
-        // No timestamp was specified: print daily bills since park creation
-        printFullBillLog(exitLog, parkTariff);
+/**
+ * @brief Corrects a visit after the fact, amending its exit or voiding it.
+ * 
+ * Only the difference is applied: the park's spots, occupants and exits,
+ * the plate's count of parks and the availability index are updated
+ * without going through the park's other visits. The caller validates the
+ * correction (see visitOverlaps) and finishes the park's billing reports
+ * first, as they hold positions of exits. A voided log is taken out of the
+ * park's table, but it lives in the log pool until the park is freed.
+ * 
+ * The park's exits are an exit tree, so taking an exit out of them or
+ * putting one in, anywhere, is O(log n) expected (see exittree.h).
+ * 
+ * @param park Pointer to the park of the visit.
+ * @param dict Pointer to the plate dictionary.
+ * @param availability Pointer to the availability index.
+ * @param passes Pointer to the global pass set.
+ * @param visit Pointer to the log of the visit.
+ * @param exit Pointer to the new exit timestamp, or NULL to void the visit.
+ * @return The change in the revenue of the park.
+ */
+double correctVisit(Park* park, PlateDict* dict,
+AvailabilityIndex* availability, const PassSet* passes, Log* visit,
+const Timestamp* exit){
+    double oldCost = getLogCost(visit);
+    unsigned int plateId = findPlateId(dict, getLogPlate(visit));
+    int wasInside = isInitialTimestamp(getExitTimestamp(visit));
+
+    if (wasInside){
+        // The vehicle was still inside: its spot is freed either way
+        (*getAvailableSpots(park))++;
+        setOpenLog(park, plateId, NULL);
+        bitmapRemove(getOccupants(park), plateId);
+        addParksInside(dict, plateId, -1);
+        updateAvailability(availability, park, *getAvailableSpots(park));
+    }
+    else {
+        // An amended exit is put back at its new place below
+        removeExitFromTree(park->exits, visit);
     }
 
-    freeLog(exitLog);
+    if (exit == NULL){
+        removeLogFromTable(getTable(park), visit);
+        removePlateVisit(dict, plateId, visit);
+        if (!plateHasLogs(getTable(park), getLogPlate(visit))){
+            bitmapRemove(getVisitors(park), plateId);
+        }
+        visit->cost = 0;
+        return -oldCost;
+    }
+
+    copyTimestamp(getExitTimestamp(visit), exit);
+    addExitToTree(park->exits, visit);
+    visit->cost = calculateStayCost(park, passes, visit);
+    return visit->cost - oldCost;
+}
+
+
+/**
+ * @brief Merges the distinct visitors sketches of a park's days in a range.
+ * 
+ * @param park Pointer to the park.
+ * @param from Pointer to the first day of the range, or NULL for no limit.
+ * @param to Pointer to the last day of the range, or NULL for no limit.
+ * @param visitors Pointer to the sketch where the days are merged.
+ */
+void mergeParkVisitors(const Park* park, const Timestamp* from,
+const Timestamp* to, HyperLogLog* visitors){
+    ParkDays* days = getParkDays(park);
+    unsigned int i = (from != NULL) ? findDayIndex(days, from) : 0;
+
+    for (; i < getNumDays(days); i++){
+        ParkDay* day = getDayAtIndex(days, i);
+        if (to != NULL && compareDate(&day->date, to) > 0){
+            break;
+        }
+        hllMerge(visitors, &day->visitors);
+    }
+}
+
+
+/**
+ * @brief Prints the estimated number of distinct vehicles that entered a
+ * park on each day, by chronological order.
+ * 
+ * @param park Pointer to the park.
+ */
+void printDailyVisitors(const Park* park){
+    ParkDays* days = getParkDays(park);
+
+    for (unsigned int i = 0; i < getNumDays(days); i++){
+        ParkDay* day = getDayAtIndex(days, i);
+        printDate(&day->date);
+        printf(" %.0f\n", hllEstimate(&day->visitors));
+    }
 }
\ No newline at end of file
@@ -8,27 +8,73 @@
 #ifndef PARK_H
 #define PARK_H
 
+#include "availability.h"
+#include "bitmap.h"
+#include "exittree.h"
+#include "hashmap.h"
 #include "hashtable.h"
 #include "log.h"
+#include "parkday.h"
+#include "pass.h"
 #include "plate.h"
+#include "platedict.h"
 #include "tariff.h"
 
+// Maximum number of parks in the system
+#define MAX_PARKS 20
+
+struct parkGroup;
+
+// Map from plate id to the log of the vehicle's stay inside a park
+HASHMAP_DEFINE(OpenLogMap, openLogMap, unsigned int, Log*, hashmapHashUint,
+                hashmapEqualUint, NO_PLATE_ID)
+
 typedef struct park {
     char* name; // name of the park
     int capacity;
     int availableSlots;
     Tariff tariff; // how much to charge for staying in the park
     Hashtable* logTable; // to store entries & exits of vehicles
+    LogPool logPool; // owns the logs of logTable
+    OpenLogMap openLogs; // log of each vehicle inside the park, by plate id
+    Bitmap* visitors; // ids of the plates that ever entered the park
+    Bitmap* occupants; // ids of the plates currently inside the park
+    ParkDays* days; // statistics of each day with activity in the park
+    ExitTree* exits; // logs with an exit, by chronological order of the exit
+    AvailabilityBucket* bucket; // bucket in the availability index, or NULL
+    struct park* prevAvailable; // neighbours in the bucket
+    struct park* nextAvailable;
+    struct parkGroup** groups; // groups the park belongs to
+    unsigned int numGroups;
+    double revenue; // billed by the exits so far
+    PassSet* passes; // passes valid only in this park, or NULL if none
     struct park* next;
 } Park;
 
+// Map from park name to park (the keys are the names of the parks)
+HASHMAP_DEFINE(ParkMap, parkMap, const char*, Park*, hashmapHashString,
+                hashmapEqualString, NULL)
+
+typedef struct entryExitHandle {
+    Park* park; // park of the command, or NULL if there's no such park
+    unsigned int plateId; // NO_PLATE_ID if never seen (or not looked up)
+    Log* openLog; // the plate's stay in progress in the park, or NULL
+    unsigned int parksInside; // number of parks the plate is inside
+} EntryExitHandle;
+
+typedef struct plateLogsJob {
+    const char* plate;
+    Park* parks[MAX_PARKS];
+    Log* logs[MAX_PARKS]; // copies of the plate's logs in each park
+} PlateLogsJob;
+
 
 // Initializer
 Park* newPark(char *name, const int* capacity, const Tariff* tariff);
 
 // Free
 void freePark(Park* park);
-void freeAllParks(Park* headPark);
+void freeAllParks(Park* headPark, Scheduler* scheduler);
 
 // Getters
 char* getParkName(Park* park);
@@ -38,23 +84,60 @@ Tariff* getTariff(Park* park);
 Hashtable* getTable(const Park* park);
 int totalParks(Park* headPark);
 Park* findLastPark(Park* headPark);
-Park* getPark(Park* headPark, const char* parkName);
-Log* getPlateLogs(Park* headPark, const char plate[PLATE_LENGTH]);
+Park* getPark(const ParkMap* parkIndex, const char* parkName);
+Log* getPlateLogs(Park* headPark, const char plate[PLATE_LENGTH],
+                    Scheduler* scheduler, Tracer* tracer);
+Bitmap* getVisitors(const Park* park);
+Bitmap* getOccupants(const Park* park);
+Bitmap* occupantsOfAllParks(Park* headPark);
+ParkDays* getParkDays(const Park* park);
+unsigned int getNumExits(const Park* park);
+Log* getExitAtIndex(const Park* park, unsigned int index);
+Log* getNextExit(const Park* park, const Log* log);
+unsigned int findFirstExit(const Park* park, const Timestamp* date);
+unsigned int findExitAfter(const Park* park, const Timestamp* date);
+PassSet* getParkPasses(const Park* park);
 
 // Removal / Insertion
-int removePark(Park** headPark, const char* parkName);
-int addPark(Park** headPark, Park* park);
+int removePark(Park** headPark, ParkMap* parkIndex, const char* parkName);
+int addPark(Park** headPark, ParkMap* parkIndex, Park* park);
 
 // Print parks
 void printParks(Park* headPark);
 void printParksAlphabetically(Park* headPark);
 
 // Check for plates in parks
-int plateInPark(const Park* park, const char plate[PLATE_LENGTH]);
-int plateInAnyPark(Park* headPark, const char plate[PLATE_LENGTH]);
+Log* getOpenLog(const Park* park, unsigned int plateId);
+int plateInPark(const Park* park, unsigned int plateId);
+
+// Passes
+void addParkPass(Park* park, const char plate[PLATE_LENGTH],
+                    const Timestamp* firstDay, const Timestamp* lastDay);
+
+// Entries and exits
+double calculateStayCost(Park* park, const PassSet* passes, Log* log);
+EntryExitHandle findEntryExit(const ParkMap* parkIndex, const PlateDict* dict,
+                    const char* parkName, const char plate[PLATE_LENGTH]);
+Log* applyEntryExit(EntryExitHandle* handle, PlateDict* dict,
+                    AvailabilityIndex* availability, const PassSet* passes,
+                    const char plate[PLATE_LENGTH], const Timestamp* timestamp,
+                    Tracer* tracer);
+Log* registerEntryExit(Park* park, const PassSet* passes,
+                        const char plate[PLATE_LENGTH], unsigned int plateId,
+                        Log* plateLastLog, const Timestamp* timestamp,
+                        Tracer* tracer);
+void releaseOccupants(const Park* park, PlateDict* dict);
+void releaseVisits(const Park* park, PlateDict* dict);
+
+// Corrections of visits
+int visitOverlaps(const PlateDict* dict, Log* visit, const Timestamp* exit);
+double correctVisit(Park* park, PlateDict* dict,
+                    AvailabilityIndex* availability, const PassSet* passes,
+                    Log* visit, const Timestamp* exit);
 
-void registerEntryExit(Park* park, const char plate[PLATE_LENGTH],
-                        const Timestamp* timestamp);
 
-void showParkBilling(Park* park, const Timestamp* timestamp);
+// Distinct visitors estimates
+void mergeParkVisitors(const Park* park, const Timestamp* from,
+                        const Timestamp* to, HyperLogLog* visitors);
+void printDailyVisitors(const Park* park);
 #endif
\ No newline at end of file
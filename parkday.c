@@ -0,0 +1,121 @@
+/**
+ * Implementation of the functions related to park days.
+ *
+ * Park days keep the statistics of a park for a single day.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "parkday.h"
+
+
+/**
+ * @brief Creates a new, empty, list of park days.
+ *
+ * @return Pointer to the new list of park days.
+ */
+ParkDays* newParkDays(){
+    ParkDays* parkDays = (ParkDays*)malloc(sizeof(ParkDays));
+
+    parkDays->capacity = PARKDAYS_INITIAL_CAPACITY;
+    parkDays->days = (ParkDay**)malloc(parkDays->capacity*sizeof(ParkDay*));
+    parkDays->numDays = 0;
+
+    return parkDays;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a list of park days.
+ *
+ * @param parkDays Pointer to the list of park days.
+ */
+void freeParkDays(ParkDays* parkDays){
+    for (unsigned int i = 0; i < parkDays->numDays; i++){
+        free(parkDays->days[i]);
+    }
+    free(parkDays->days);
+    free(parkDays);
+}
+
+
+/**
+ * @brief Retrieves the number of days in a list of park days.
+ *
+ * @param parkDays Pointer to the list of park days.
+ * @return The number of days.
+ */
+unsigned int getNumDays(const ParkDays* parkDays){
+    return parkDays->numDays;
+}
+
+
+/**
+ * @brief Retrieves the day at the given position (days are sorted by date).
+ *
+ * @param parkDays Pointer to the list of park days.
+ * @param index Position of the day.
+ * @return Pointer to the park day.
+ */
+ParkDay* getDayAtIndex(const ParkDays* parkDays, unsigned int index){
+    return parkDays->days[index];
+}
+
+
+/**
+ * @brief Finds the position of the first day not before the given date.
+ *
+ * @param parkDays Pointer to the list of park days.
+ * @param date Pointer to the date (only day, month and year are used).
+ * @return Position of the day, or getNumDays if every day is before date.
+ */
+unsigned int findDayIndex(const ParkDays* parkDays, const Timestamp* date){
+    unsigned int low = 0, high = parkDays->numDays;
+
+    // Days are nearly always added in chronological order
+    if (high > 0 && compareDate(&parkDays->days[high - 1]->date, date) < 0){
+        return high;
+    }
+    while (low < high){
+        unsigned int middle = (low + high) / 2;
+        if (compareDate(&parkDays->days[middle]->date, date) < 0)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+
+/**
+ * @brief Retrieves the day with the given date, creating it if needed.
+ *
+ * @param parkDays Pointer to the list of park days.
+ * @param date Pointer to the date (only day, month and year are used).
+ * @return Pointer to the park day.
+ */
+ParkDay* getParkDay(ParkDays* parkDays, const Timestamp* date){
+    unsigned int index = findDayIndex(parkDays, date);
+
+    if (index < parkDays->numDays &&
+        compareDate(&parkDays->days[index]->date, date) == 0){
+        return parkDays->days[index];
+    }
+
+    if (parkDays->numDays == parkDays->capacity){
+        parkDays->capacity *= 2;
+        parkDays->days = (ParkDay**)realloc(parkDays->days,
+                            parkDays->capacity * sizeof(ParkDay*));
+    }
+    memmove(&parkDays->days[index + 1], &parkDays->days[index],
+            (parkDays->numDays - index) * sizeof(ParkDay*));
+    parkDays->numDays++;
+
+    ParkDay* day = (ParkDay*)malloc(sizeof(ParkDay));
+    day->date = newTimestamp(date->day, date->month, date->year, 0, 0);
+    initHyperLogLog(&day->visitors);
+    parkDays->days[index] = day;
+    return day;
+}
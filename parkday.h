@@ -0,0 +1,42 @@
+/**
+ * Definition of the park day structs, and of the related function
+ * prototypes.
+ *
+ * Park days keep the statistics of a park for a single day, such as an
+ * estimate of the distinct vehicles that entered it that day.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef PARKDAY_H
+#define PARKDAY_H
+
+#include "hyperloglog.h"
+#include "timestamp.h"
+
+// Initial length of the days array
+#define PARKDAYS_INITIAL_CAPACITY 8
+
+typedef struct parkDay {
+    Timestamp date; // the day (hour and minute are always 0)
+    HyperLogLog visitors; // sketch of the plates that entered in the day
+} ParkDay;
+
+typedef struct parkDays {
+    ParkDay** days; // sorted by date
+    unsigned int numDays;
+    unsigned int capacity; // allocated length of days
+} ParkDays;
+
+
+// Initializer
+ParkDays* newParkDays();
+
+// Free
+void freeParkDays(ParkDays* parkDays);
+
+// Getters
+unsigned int getNumDays(const ParkDays* parkDays);
+ParkDay* getDayAtIndex(const ParkDays* parkDays, unsigned int index);
+unsigned int findDayIndex(const ParkDays* parkDays, const Timestamp* date);
+ParkDay* getParkDay(ParkDays* parkDays, const Timestamp* date);
+#endif
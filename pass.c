@@ -0,0 +1,115 @@
+/**
+ * Implementation of the functions related to pass sets.
+ *
+ * Pass sets hold the ranges of days in which vehicles are billed zero.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "pass.h"
+
+// Multiplier of the Fibonacci hashing of packed plates
+#define PASS_HASH_MULTIPLIER 2654435769u
+// Bits of the hash that choose a bucket (log2 of PASS_BUCKETS)
+#define PASS_BUCKET_BITS 8
+
+
+/**
+ * @brief Chooses the bucket of a packed plate.
+ *
+ * @param packedPlate The packed plate.
+ * @return Index of the bucket.
+ */
+unsigned int passBucket(unsigned int packedPlate){
+    return (packedPlate * PASS_HASH_MULTIPLIER) >> (32 - PASS_BUCKET_BITS);
+}
+
+
+/**
+ * @brief Creates a new, empty, pass set.
+ *
+ * @return Pointer to the new pass set.
+ */
+PassSet* newPassSet(){
+    PassSet* passes = (PassSet*)malloc(sizeof(PassSet));
+
+    passes->holders = newBitmap();
+    for (unsigned int i = 0; i < PASS_BUCKETS; i++){
+        passes->buckets[i] = NULL;
+    }
+    return passes;
+}
+
+
+/**
+ * @brief Frees a pass set and its ranges.
+ *
+ * @param passes Pointer to the pass set, or NULL.
+ */
+void freePassSet(PassSet* passes){
+    if (passes == NULL){
+        return;
+    }
+    for (unsigned int i = 0; i < PASS_BUCKETS; i++){
+        PassRange* range = passes->buckets[i];
+        while (range != NULL){
+            PassRange* next = range->next;
+            free(range);
+            range = next;
+        }
+    }
+    freeBitmap(passes->holders);
+    free(passes);
+}
+
+
+/**
+ * @brief Adds a pass to a set.
+ *
+ * A vehicle may have many passes, their ranges may overlap.
+ *
+ * @param passes Pointer to the pass set.
+ * @param plate The license plate of the holder.
+ * @param firstDay Pointer to the first day the pass is valid.
+ * @param lastDay Pointer to the last day the pass is valid.
+ */
+void addPass(PassSet* passes, const char plate[PLATE_LENGTH],
+const Timestamp* firstDay, const Timestamp* lastDay){
+    PassRange* range = (PassRange*)malloc(sizeof(PassRange));
+    unsigned int bucket;
+
+    range->packedPlate = packPlate(plate);
+    copyTimestamp(&range->firstDay, firstDay);
+    copyTimestamp(&range->lastDay, lastDay);
+    bucket = passBucket(range->packedPlate);
+    range->next = passes->buckets[bucket];
+    passes->buckets[bucket] = range;
+    bitmapAdd(passes->holders, range->packedPlate);
+}
+
+
+/**
+ * @brief Checks if a vehicle has a pass valid on a given day.
+ *
+ * @param passes Pointer to the pass set, or NULL for no passes.
+ * @param packedPlate The packed plate of the vehicle.
+ * @param day Pointer to a timestamp of the day (its time is ignored).
+ * @return 1 if the vehicle has a valid pass, 0 otherwise.
+ */
+int hasPass(const PassSet* passes, unsigned int packedPlate,
+const Timestamp* day){
+    if (passes == NULL || !bitmapContains(passes->holders, packedPlate)){
+        return 0;
+    }
+
+    PassRange* range = passes->buckets[passBucket(packedPlate)];
+    for (; range != NULL; range = range->next){
+        if (range->packedPlate == packedPlate &&
+            compareDate(&range->firstDay, day) <= 0 &&
+            compareDate(day, &range->lastDay) <= 0){
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * Definition of the pass set structs, and of the function prototypes
+ * related to them.
+ *
+ * A pass set holds the season passes (and exemptions) of the vehicles
+ * billed zero: each pass is a range of days, keyed by the packed plate.
+ * There's a global set, and a set for each park with passes of its own.
+ * A bitmap of the holders answers the common case, a vehicle without any
+ * pass, before the ranges are looked at.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef PASS_H
+#define PASS_H
+
+#include "bitmap.h"
+#include "plate.h"
+#include "timestamp.h"
+
+// Number of buckets of the pass ranges (a power of two)
+#define PASS_BUCKETS 256
+
+typedef struct passRange {
+    unsigned int packedPlate; // plate of the holder
+    Timestamp firstDay; // first day the pass is valid
+    Timestamp lastDay; // last day the pass is valid
+    struct passRange* next; // next range in the same bucket
+} PassRange;
+
+typedef struct passSet {
+    Bitmap* holders; // packed plates with at least one pass
+    PassRange* buckets[PASS_BUCKETS]; // ranges, by hash of the packed plate
+} PassSet;
+
+
+// Initializer
+PassSet* newPassSet();
+
+// Free
+void freePassSet(PassSet* passes);
+
+// Insertion
+void addPass(PassSet* passes, const char plate[PLATE_LENGTH],
+                const Timestamp* firstDay, const Timestamp* lastDay);
+
+// Lookup
+int hasPass(const PassSet* passes, unsigned int packedPlate,
+            const Timestamp* day);
+#endif
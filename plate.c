@@ -77,4 +77,51 @@ int validPlate(const char plate[PLATE_LENGTH]){
 
     // Must have atleast 1 pair of numbers and letters
     return (numberPairs > 0 && letterPairs > 0) ? 1 : 0;
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Packs a valid licence plate into a 32-bit integer.
+ * 
+ * Each of the 6 plate characters is a base 36 digit (0-9 then A-Z), so a
+ * plate fits in 36^6 < 2^32 values. Because digits come before letters, the
+ * packed values keep the alphabetical order of the plates.
+ * 
+ * @param plate The licence plate to pack (must be valid).
+ * @return The packed licence plate.
+ */
+unsigned int packPlate(const char plate[PLATE_LENGTH]){
+    unsigned int packed = 0;
+
+    for (int i = 0; i < PLATE_LENGTH - 1; i++){
+        if (plate[i] == '-')
+            continue;
+        packed = packed * PLATE_SYMBOLS + (isDigit(&plate[i]) ?
+            (unsigned int)(plate[i] - '0') :
+            (unsigned int)(plate[i] - 'A' + 10));
+    }
+
+    return packed;
+}
+
+
+/**
+ * @brief Unpacks a licence plate previously packed with packPlate.
+ * 
+ * @param packed The packed licence plate.
+ * @param plate Where to write the licence plate (XX-XX-XX).
+ */
+void unpackPlate(unsigned int packed, char plate[PLATE_LENGTH]){
+    plate[PLATE_LENGTH - 1] = '\0';
+
+    // Fill the plate from the last character to the first
+    for (int i = PLATE_LENGTH - 2; i >= 0; i--){
+        if (i == 2 || i == 5){
+            plate[i] = '-';
+            continue;
+        }
+        unsigned int symbol = packed % PLATE_SYMBOLS;
+        plate[i] = (char)(symbol < 10 ? '0' + symbol : 'A' + symbol - 10);
+        packed /= PLATE_SYMBOLS;
+    }
+}
@@ -9,6 +9,13 @@
 // XX-XX-XX plus 1 space for \0
 #define PLATE_LENGTH 9
 
+// Number of different symbols a plate character can take (0-9 and A-Z)
+#define PLATE_SYMBOLS 36
+
 void printPlate(const char plate[PLATE_LENGTH]);
 int validPlate(const char plate[PLATE_LENGTH]);
+
+// Packing into (and out of) a 32-bit integer
+unsigned int packPlate(const char plate[PLATE_LENGTH]);
+void unpackPlate(unsigned int packed, char plate[PLATE_LENGTH]);
 #endif
\ No newline at end of file
@@ -0,0 +1,291 @@
+/**
+ * Implementation of the functions related to the plate dictionary.
+ *
+ * The plate dictionary interns every licence plate seen by the system,
+ * giving each distinct plate a dense integer id on its first sighting.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "platedict.h"
+
+
+/**
+ * @brief Creates a new, empty, plate dictionary.
+ *
+ * @return Pointer to the newly created plate dictionary.
+ */
+PlateDict* newPlateDict(){
+    PlateDict* dict = (PlateDict*)malloc(sizeof(PlateDict));
+
+    plateIdMapInit(&dict->ids);
+    dict->capacity = PLATEDICT_INITIAL_CAPACITY;
+    plateIdMapReserve(&dict->ids, dict->capacity);
+    dict->packedPlates =
+        (unsigned int*)malloc(dict->capacity * sizeof(unsigned int));
+    dict->parksInside = (unsigned char*)malloc(dict->capacity);
+    dict->lastVisits = (Log**)malloc(dict->capacity * sizeof(Log*));
+    dict->overlapping = newBitmap();
+    dict->numPlates = 0;
+
+    return dict;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a plate dictionary.
+ *
+ * @param dict Pointer to the plate dictionary.
+ */
+void freePlateDict(PlateDict* dict){
+    plateIdMapFree(&dict->ids);
+    free(dict->packedPlates);
+    free(dict->parksInside);
+    free(dict->lastVisits);
+    freeBitmap(dict->overlapping);
+    free(dict);
+}
+
+
+/**
+ * @brief Gets the id of a plate, assigning it the next free id if the plate
+ * was never seen before.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param plate The licence plate (must be valid).
+ * @return The id of the plate.
+ */
+unsigned int internPlate(PlateDict* dict, const char plate[PLATE_LENGTH]){
+    unsigned int packed = packPlate(plate);
+    unsigned int* found = plateIdMapFind(&dict->ids, packed);
+
+    if (found != NULL){
+        return *found;
+    }
+
+    // First sighting of the plate
+    if (dict->numPlates == dict->capacity){
+        dict->capacity *= 2;
+        dict->packedPlates = (unsigned int*)realloc(dict->packedPlates,
+            dict->capacity * sizeof(unsigned int));
+        dict->parksInside = (unsigned char*)realloc(dict->parksInside,
+            dict->capacity);
+        dict->lastVisits = (Log**)realloc(dict->lastVisits,
+            dict->capacity * sizeof(Log*));
+    }
+    unsigned int id = dict->numPlates++;
+    dict->packedPlates[id] = packed;
+    dict->parksInside[id] = 0;
+    dict->lastVisits[id] = NULL;
+    plateIdMapPut(&dict->ids, packed, id);
+
+    return id;
+}
+
+
+/**
+ * @brief Gets the id of a plate without interning it.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param plate The licence plate (must be valid).
+ * @return The id of the plate, or NO_PLATE_ID if it was never interned.
+ */
+unsigned int findPlateId(const PlateDict* dict,
+const char plate[PLATE_LENGTH]){
+    const unsigned int* found = plateIdMapFind(&dict->ids, packPlate(plate));
+
+    return found != NULL ? *found : NO_PLATE_ID;
+}
+
+
+/**
+ * @brief Retrieves the number of parks a plate is inside.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate, or NO_PLATE_ID if it was never interned.
+ * @return The number of parks (0 for a plate never interned).
+ */
+unsigned int getParksInside(const PlateDict* dict, unsigned int id){
+    return id == NO_PLATE_ID ? 0 : dict->parksInside[id];
+}
+
+
+/**
+ * @brief Updates the number of parks a plate is inside.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate (must have been interned).
+ * @param delta 1 when the plate enters a park, -1 when it leaves one.
+ */
+void addParksInside(PlateDict* dict, unsigned int id, int delta){
+    dict->parksInside[id] += delta;
+}
+
+
+/**
+ * @brief Chains a new visit of a plate after its latest one.
+ *
+ * Entries are registered in chronological order, so the chain is sorted by
+ * entry. A vehicle is usually in one park at a time, and then its visits
+ * don't overlap. But an exit from a park the vehicle isn't in, while it's
+ * inside another, is registered as an entry: the plate is then marked as
+ * having overlapping visits. Until it is, only its latest visit can still
+ * be going on when a new one starts.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate (must have been interned).
+ * @param visit Pointer to the log of the visit.
+ */
+void addPlateVisit(PlateDict* dict, unsigned int id, Log* visit){
+    Log* last = dict->lastVisits[id];
+
+    if (last != NULL && (isInitialTimestamp(getExitTimestamp(last)) ||
+        compareTimestamps(getExitTimestamp(last),
+                            getEntryTimestamp(visit)) > 0)){
+        bitmapAdd(dict->overlapping, id);
+    }
+    visit->prevVisit = last;
+    visit->nextVisit = NULL;
+    if (last != NULL){
+        last->nextVisit = visit;
+    }
+    dict->lastVisits[id] = visit;
+}
+
+
+/**
+ * @brief Takes a visit (voided, or of a removed park) out of its plate's
+ * chain.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate (must have been interned).
+ * @param visit Pointer to the log of the visit, which must be chained.
+ */
+void removePlateVisit(PlateDict* dict, unsigned int id, Log* visit){
+    if (visit->prevVisit != NULL){
+        visit->prevVisit->nextVisit = visit->nextVisit;
+    }
+    if (visit->nextVisit != NULL){
+        visit->nextVisit->prevVisit = visit->prevVisit;
+    }
+    else {
+        dict->lastVisits[id] = visit->prevVisit;
+    }
+    visit->prevVisit = visit->nextVisit = NULL;
+}
+
+
+/**
+ * @brief Checks if a plate ever had visits that overlap (see addPlateVisit).
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate (must have been interned).
+ * @return 1 if the plate had overlapping visits, 0 otherwise.
+ */
+int plateVisitsOverlap(const PlateDict* dict, unsigned int id){
+    return bitmapContains(dict->overlapping, id);
+}
+
+
+/**
+ * @brief Retrieves the number of plates interned in the dictionary.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @return The number of interned plates, which is also the next id.
+ */
+unsigned int getNumPlates(const PlateDict* dict){
+    return dict->numPlates;
+}
+
+
+/**
+ * @brief Retrieves the packed plate with the given id.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate (must have been interned).
+ * @return The packed licence plate.
+ */
+unsigned int getPackedPlate(const PlateDict* dict, unsigned int id){
+    return dict->packedPlates[id];
+}
+
+
+/**
+ * @brief Writes the licence plate with the given id.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param id The id of the plate (must have been interned).
+ * @param plate Where to write the licence plate.
+ */
+void getPlateById(const PlateDict* dict, unsigned int id,
+char plate[PLATE_LENGTH]){
+    unpackPlate(dict->packedPlates[id], plate);
+}
+
+
+/**
+ * @brief Sorts packed plates in ascending (alphabetical) order.
+ * 
+ * Uses a least significant digit radix sort, sorting RADIX_BITS bits of
+ * the packed plates in each pass.
+ *
+ * @param packed The packed plates to sort.
+ * @param n Number of packed plates.
+ */
+void sortPackedPlates(unsigned int* packed, unsigned int n){
+    unsigned int* aux = (unsigned int*)malloc(n * sizeof(unsigned int) + 1);
+    unsigned int* from = packed;
+    unsigned int* to = aux;
+
+    for (unsigned int shift = 0; shift < sizeof(unsigned int) * 8;
+        shift += RADIX_BITS){
+        unsigned int count[RADIX_BUCKETS + 1] = {0};
+
+        // Count the plates in each bucket, then turn counts into positions
+        for (unsigned int i = 0; i < n; i++)
+            count[((from[i] >> shift) & (RADIX_BUCKETS - 1)) + 1]++;
+        for (unsigned int b = 0; b < RADIX_BUCKETS; b++)
+            count[b + 1] += count[b];
+        for (unsigned int i = 0; i < n; i++)
+            to[count[(from[i] >> shift) & (RADIX_BUCKETS - 1)]++] = from[i];
+
+        unsigned int* swap = from;
+        from = to;
+        to = swap;
+    }
+
+    // An even number of passes leaves the result back in packed
+    free(aux);
+}
+
+
+/**
+ * @brief Prints, in alphabetical order, the plates in a set of plate ids.
+ *
+ * Each plate is printed on its own line.
+ *
+ * @param dict Pointer to the plate dictionary.
+ * @param plateIds Pointer to the bitmap with the plate ids.
+ */
+void printPlateSet(const PlateDict* dict, const Bitmap* plateIds){
+    unsigned int n = bitmapCardinality(plateIds);
+    unsigned int* packed = (unsigned int*)malloc(n*sizeof(unsigned int) + 1);
+    char plate[PLATE_LENGTH];
+
+    bitmapToArray(plateIds, packed);
+    // Replace each id by its packed plate, which sorts alphabetically
+    for (unsigned int i = 0; i < n; i++){
+        packed[i] = getPackedPlate(dict, packed[i]);
+    }
+    sortPackedPlates(packed, n);
+
+    for (unsigned int i = 0; i < n; i++){
+        unpackPlate(packed[i], plate);
+        printPlate(plate);
+        printf("\n");
+    }
+
+    free(packed);
+}
@@ -0,0 +1,77 @@
+/**
+ * Definition of the plate dictionary struct, and of the function prototypes
+ * related to it.
+ *
+ * The plate dictionary interns every licence plate seen by the system,
+ * giving each distinct plate a dense integer id (0, 1, 2, ...) on its first
+ * sighting. Per-park structures can then be indexed by id instead of hashing
+ * plate strings again. The dictionary also counts the parks each plate is
+ * inside, so an entry/exit checks it without visiting the parks, and chains
+ * the visits of each plate in every park, so a correction finds the plate's
+ * next visit without visiting the parks either.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef PLATEDICT_H
+#define PLATEDICT_H
+
+#include "bitmap.h"
+#include "hashmap.h"
+#include "log.h"
+#include "plate.h"
+
+// Id returned when a plate was never interned
+#define NO_PLATE_ID 0xFFFFFFFFu
+// Never a packed plate (36^6 packed plates fit below it)
+#define NO_PACKED_PLATE 0xFFFFFFFFu
+// Number of bits sorted by each pass of the radix sort
+#define RADIX_BITS 8
+// Number of buckets of each pass of the radix sort
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+// Initial number of ids the dictionary has room for
+#define PLATEDICT_INITIAL_CAPACITY 1024
+
+// Map from packed plate to id
+HASHMAP_DEFINE(PlateIdMap, plateIdMap, unsigned int, unsigned int,
+                hashmapHashUint, hashmapEqualUint, NO_PACKED_PLATE)
+
+typedef struct plateDict {
+    PlateIdMap ids; // id of each packed plate
+    unsigned int* packedPlates; // packed plate of each id
+    unsigned char* parksInside; // number of parks each id is inside
+    Log** lastVisits; // latest visit of each id, in any park, or NULL
+    Bitmap* overlapping; // ids with visits that overlap (see addPlateVisit)
+    unsigned int numPlates; // number of interned plates (next id to assign)
+    unsigned int capacity; // allocated length of packedPlates
+} PlateDict;
+
+
+// Initializer
+PlateDict* newPlateDict();
+
+// Free
+void freePlateDict(PlateDict* dict);
+
+// Interning and lookup
+unsigned int internPlate(PlateDict* dict, const char plate[PLATE_LENGTH]);
+unsigned int findPlateId(const PlateDict* dict,
+                        const char plate[PLATE_LENGTH]);
+
+// Parks the plates are inside
+unsigned int getParksInside(const PlateDict* dict, unsigned int id);
+void addParksInside(PlateDict* dict, unsigned int id, int delta);
+
+// Visits of the plates, in any park
+void addPlateVisit(PlateDict* dict, unsigned int id, Log* visit);
+void removePlateVisit(PlateDict* dict, unsigned int id, Log* visit);
+int plateVisitsOverlap(const PlateDict* dict, unsigned int id);
+
+// Getters
+unsigned int getNumPlates(const PlateDict* dict);
+unsigned int getPackedPlate(const PlateDict* dict, unsigned int id);
+void getPlateById(const PlateDict* dict, unsigned int id,
+                    char plate[PLATE_LENGTH]);
+
+// Print a set of plate ids
+void printPlateSet(const PlateDict* dict, const Bitmap* plateIds);
+#endif
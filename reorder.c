@@ -0,0 +1,162 @@
+/**
+ * Implementation of the functions related to the reorder buffer.
+ *
+ * The reorder buffer holds entry/exit commands in a min-heap keyed by the
+ * minute of their timestamp, releasing them in chronological order once
+ * they fall behind the watermark.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdlib.h>
+#include <string.h>
+#include "reorder.h"
+
+// Initial length of the heap
+#define REORDER_INITIAL_CAPACITY 64
+
+
+/**
+ * @brief Creates a new, empty, reorder buffer.
+ *
+ * @param watermark Minutes a command may arrive behind the newest one.
+ * @return Pointer to the new reorder buffer.
+ */
+ReorderBuffer* newReorderBuffer(int watermark){
+    ReorderBuffer* buffer = (ReorderBuffer*)malloc(sizeof(ReorderBuffer));
+
+    buffer->capacity = REORDER_INITIAL_CAPACITY;
+    buffer->heap = (PendingLine*)malloc(buffer->capacity*sizeof(PendingLine));
+    buffer->size = 0;
+    buffer->watermark = watermark;
+    buffer->newestMinute = 0;
+    buffer->nextSequence = 0;
+
+    return buffer;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a reorder buffer, including the
+ * commands it still holds.
+ *
+ * @param buffer Pointer to the reorder buffer.
+ */
+void freeReorderBuffer(ReorderBuffer* buffer){
+    for (unsigned int i = 0; i < buffer->size; i++){
+        free(buffer->heap[i].line);
+    }
+    free(buffer->heap);
+    free(buffer);
+}
+
+
+/**
+ * @brief Checks if a pending command must be released before another.
+ *
+ * @param a Pointer to the first pending command.
+ * @param b Pointer to the second pending command.
+ * @return 1 if a comes first, 0 otherwise.
+ */
+int pendingBefore(const PendingLine* a, const PendingLine* b){
+    return a->minute < b->minute ||
+            (a->minute == b->minute && a->sequence < b->sequence);
+}
+
+
+/**
+ * @brief Adds a command to the reorder buffer.
+ *
+ * @param buffer Pointer to the reorder buffer.
+ * @param minute The minute of the command's timestamp.
+ * @param line The command (it is copied).
+ */
+void reorderPush(ReorderBuffer* buffer, int minute, const char* line){
+    if (buffer->size == buffer->capacity){
+        buffer->capacity *= 2;
+        buffer->heap = (PendingLine*)realloc(buffer->heap,
+                        buffer->capacity * sizeof(PendingLine));
+    }
+    if (minute > buffer->newestMinute){
+        buffer->newestMinute = minute;
+    }
+
+    PendingLine pending;
+    pending.minute = minute;
+    pending.sequence = buffer->nextSequence++;
+    pending.line = (char*)malloc(strlen(line) + 1);
+    strcpy(pending.line, line);
+
+    // Sift the new command up to its place
+    unsigned int i = buffer->size++;
+    while (i > 0 && pendingBefore(&pending, &buffer->heap[(i - 1) / 2])){
+        buffer->heap[i] = buffer->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    buffer->heap[i] = pending;
+}
+
+
+/**
+ * @brief Removes the oldest command of the reorder buffer.
+ *
+ * @param buffer Pointer to the reorder buffer.
+ * @return The command (to be freed by the caller), or NULL if empty.
+ */
+char* reorderPop(ReorderBuffer* buffer){
+    if (buffer->size == 0){
+        return NULL;
+    }
+
+    char* line = buffer->heap[0].line;
+    PendingLine last = buffer->heap[--buffer->size];
+
+    // Sift the last command down from the root
+    unsigned int i = 0;
+    while (2 * i + 1 < buffer->size){
+        unsigned int child = 2 * i + 1;
+        if (child + 1 < buffer->size &&
+            pendingBefore(&buffer->heap[child + 1], &buffer->heap[child])){
+            child++;
+        }
+        if (!pendingBefore(&buffer->heap[child], &last)){
+            break;
+        }
+        buffer->heap[i] = buffer->heap[child];
+        i = child;
+    }
+    buffer->heap[i] = last;
+
+    return line;
+}
+
+
+/**
+ * @brief Removes the oldest command of the reorder buffer if it is ready.
+ *
+ * A command is ready once it is at least the watermark behind the newest
+ * minute seen, or when the buffer holds too many commands.
+ *
+ * @param buffer Pointer to the reorder buffer.
+ * @return The command (to be freed by the caller), or NULL if none is ready
+ */
+char* reorderPopReady(ReorderBuffer* buffer){
+    if (buffer->size == 0){
+        return NULL;
+    }
+    if (buffer->heap[0].minute > buffer->newestMinute - buffer->watermark &&
+        buffer->size <= REORDER_MAX_PENDING){
+        return NULL;
+    }
+    return reorderPop(buffer);
+}
+
+
+/**
+ * @brief Retrieves the newest minute seen by the reorder buffer.
+ *
+ * @param buffer Pointer to the reorder buffer.
+ * @return The newest minute of the commands pushed so far.
+ */
+int getNewestMinute(const ReorderBuffer* buffer){
+    return buffer->newestMinute;
+}
@@ -0,0 +1,47 @@
+/**
+ * Definition of the reorder buffer struct, and of the function prototypes
+ * related to it.
+ *
+ * The reorder buffer holds entry/exit commands that arrive slightly out of
+ * chronological order. Commands wait in a min-heap keyed by the minute of
+ * their timestamp until they are older than the newest minute seen minus a
+ * watermark, and are then released in chronological order.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef REORDER_H
+#define REORDER_H
+
+// Maximum number of commands held; beyond it the oldest is released early
+#define REORDER_MAX_PENDING 65536
+
+typedef struct pendingLine {
+    int minute; // minute of the command's timestamp
+    unsigned long sequence; // arrival order, to break ties
+    char* line; // copy of the command
+} PendingLine;
+
+typedef struct reorderBuffer {
+    PendingLine* heap; // min-heap by (minute, sequence)
+    unsigned int size;
+    unsigned int capacity; // allocated length of heap
+    int watermark; // minutes a command may arrive late
+    int newestMinute; // newest minute seen so far
+    unsigned long nextSequence;
+} ReorderBuffer;
+
+
+// Initializer
+ReorderBuffer* newReorderBuffer(int watermark);
+
+// Free
+void freeReorderBuffer(ReorderBuffer* buffer);
+
+// Insertion and removal
+void reorderPush(ReorderBuffer* buffer, int minute, const char* line);
+char* reorderPopReady(ReorderBuffer* buffer);
+char* reorderPop(ReorderBuffer* buffer);
+
+// Getters
+int getNewestMinute(const ReorderBuffer* buffer);
+#endif
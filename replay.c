@@ -0,0 +1,378 @@
+/**
+ * Implementation of the functions related to the replay of event files.
+ *
+ * Runs of entries/exits are scanned in order to decide each line's outcome,
+ * then applied to the parks in parallel, and answered in input order.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "command.h"
+#include "group.h"
+#include "replay.h"
+
+
+/**
+ * @brief Creates a new, empty, replay segment.
+ *
+ * @return Pointer to the new replay segment.
+ */
+ReplaySegment* newReplaySegment(){
+    ReplaySegment* segment = (ReplaySegment*)malloc(sizeof(ReplaySegment));
+
+    segment->lines =
+        (ReplayLine*)malloc(REPLAY_SEGMENT_LINES * sizeof(ReplayLine));
+    segment->numLines = 0;
+
+    return segment;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a replay segment.
+ *
+ * @param segment Pointer to the replay segment.
+ */
+void freeReplaySegment(ReplaySegment* segment){
+    for (unsigned int i = 0; i < segment->numLines; i++){
+        free(segment->lines[i].text);
+    }
+    free(segment->lines);
+    free(segment);
+}
+
+
+/**
+ * @brief Checks if a replay segment can't take any more lines.
+ *
+ * @param segment Pointer to the replay segment.
+ * @return 1 if the segment is full, 0 otherwise.
+ */
+int replaySegmentFull(const ReplaySegment* segment){
+    return segment->numLines == REPLAY_SEGMENT_LINES;
+}
+
+
+/**
+ * @brief Adds an entry/exit line to a replay segment (which can't be full).
+ *
+ * @param segment Pointer to the replay segment.
+ * @param line The command line, which is copied.
+ */
+void addReplayLine(ReplaySegment* segment, const char* line){
+    ReplayLine* replayLine = &segment->lines[segment->numLines++];
+
+    replayLine->text = (char*)malloc(strlen(line) + 1);
+    strcpy(replayLine->text, line);
+}
+
+
+/**
+ * @brief Prepares the scan of a segment from the current state of the
+ * parks.
+ *
+ * @param scan Pointer to the scan.
+ * @param context Pointer to the replay context.
+ */
+void startScan(ReplayScan* scan, const ReplayContext* context){
+    scan->numParks = 0;
+    for (Park* park = context->headPark; park != NULL; park = park->next){
+        scan->availableSpots[scan->numParks] = *getAvailableSpots(park);
+        scan->parks[scan->numParks++] = park;
+    }
+
+    scan->masksSize = getNumPlates(context->plateDict) + 1;
+    scan->parkMasks =
+        (unsigned int*)calloc(scan->masksSize, sizeof(unsigned int));
+    for (unsigned int p = 0; p < scan->numParks; p++){
+        Bitmap* occupants = getOccupants(scan->parks[p]);
+        unsigned int n = bitmapCardinality(occupants);
+        unsigned int* ids = (unsigned int*)malloc(n * sizeof(unsigned int) + 1);
+        bitmapToArray(occupants, ids);
+        for (unsigned int i = 0; i < n; i++){
+            scan->parkMasks[ids[i]] |= 1u << p;
+        }
+        free(ids);
+    }
+
+    // The answers are buffered as written, a digest only sees them in order
+    scan->errors.binary = context->out->binary;
+    scan->errors.stream = open_memstream(&scan->buffer, &scan->bufferSize);
+}
+
+
+/**
+ * @brief Retrieves the mask of the parks a plate is inside.
+ *
+ * @param scan Pointer to the scan.
+ * @param plateId The id of the plate, or NO_PLATE_ID.
+ * @return Pointer to the mask, or NULL if the plate was never interned.
+ */
+unsigned int* getParkMask(ReplayScan* scan, unsigned int plateId){
+    if (plateId == NO_PLATE_ID){
+        return NULL;
+    }
+    if (plateId >= scan->masksSize){
+        unsigned int size = scan->masksSize;
+        scan->masksSize = 2 * plateId + 1;
+        scan->parkMasks = (unsigned int*)realloc(scan->parkMasks,
+                            scan->masksSize * sizeof(unsigned int));
+        memset(scan->parkMasks + size, 0,
+                (scan->masksSize - size) * sizeof(unsigned int));
+    }
+    return &scan->parkMasks[plateId];
+}
+
+
+/**
+ * @brief Finds the position of a park in the scan.
+ *
+ * @param scan Pointer to the scan.
+ * @param parkName The name of the park.
+ * @return The position of the park, or scan->numParks if it doesn't exist.
+ */
+unsigned int findParkIndex(const ReplayScan* scan, const char* parkName){
+    unsigned int p = 0;
+
+    while (p < scan->numParks &&
+            strcmp(getParkName(scan->parks[p]), parkName) != 0){
+        p++;
+    }
+    return p;
+}
+
+
+/**
+ * @brief Validates an entry/exit against the state of the scan, writing
+ * the error of the first failed check.
+ *
+ * The checks, and their order, are the ones of the 'e' and 's' commands.
+ *
+ * @param scan Pointer to the scan.
+ * @param context Pointer to the replay context.
+ * @param command The command character ('e' or 's').
+ * @param parkName The name of the park.
+ * @param line Pointer to the line, with its plate and timestamp.
+ * @return 1 if the entry/exit is valid, 0 otherwise.
+ */
+int validScannedLine(ReplayScan* scan, const ReplayContext* context,
+char command, const char* parkName, ReplayLine* line){
+    unsigned int p = findParkIndex(scan, parkName);
+
+    if (p == scan->numParks){
+        outputError(&scan->errors, ERROR_NO_SUCH_PARKING, parkName);
+        return 0;
+    }
+    if (command == 'e' && scan->availableSpots[p] <= 0){
+        outputError(&scan->errors, ERROR_PARKING_FULL, parkName);
+        return 0;
+    }
+    if (!validPlate(line->plate)){
+        outputError(&scan->errors, ERROR_INVALID_PLATE, line->plate);
+        return 0;
+    }
+
+    unsigned int* mask = getParkMask(scan,
+                            findPlateId(context->plateDict, line->plate));
+    int inAnyPark = (mask != NULL && *mask != 0);
+    if ((command == 'e' && inAnyPark) || (command == 's' && !inAnyPark)){
+        outputError(&scan->errors,
+            (command == 'e') ? ERROR_INVALID_ENTRY : ERROR_INVALID_EXIT,
+            line->plate);
+        return 0;
+    }
+
+    if (!validTimestamp(&line->timestamp) ||
+        compareTimestamps(context->lastTimestamp, &line->timestamp) == 1){
+        outputError(&scan->errors, ERROR_INVALID_DATE, "");
+        return 0;
+    }
+
+    line->parkIndex = p;
+    return 1;
+}
+
+
+/**
+ * @brief Decides the outcome of a line, updating the state of the scan as
+ * registering it would update the parks.
+ *
+ * @param scan Pointer to the scan.
+ * @param context Pointer to the replay context.
+ * @param line Pointer to the line.
+ */
+void scanLine(ReplayScan* scan, const ReplayContext* context,
+ReplayLine* line){
+    char command;
+    char parkName[PARK_NAME_LENGTH];
+    int consumed;
+    unsigned long long eventId;
+
+    parseEntryExit(line->text, &command, parkName, line->plate,
+                    &line->timestamp, &consumed);
+
+    int hasEventId = parseEventId(line->text, consumed, &eventId);
+    if (hasEventId && dedupeContains(context->dedupeFilter, eventId)){
+        line->outcome = REPLAY_DROPPED;
+        return;
+    }
+
+    line->offset = ftell(scan->errors.stream);
+    if (!validScannedLine(scan, context, command, parkName, line)){
+        line->outcome = REPLAY_REJECTED;
+        line->buffer = scan->numParks;
+        line->length = ftell(scan->errors.stream) - line->offset;
+        return;
+    }
+
+    // Like registerEntryExit, an exit only if inside this very park
+    unsigned int p = line->parkIndex;
+    line->outcome = REPLAY_APPLIED;
+    line->buffer = p;
+    line->plateId = internPlate(context->plateDict, line->plate);
+    unsigned int* mask = getParkMask(scan, line->plateId);
+    if (*mask & (1u << p)){
+        line->type = EVENT_EXIT;
+        *mask &= ~(1u << p);
+        scan->availableSpots[p]++;
+        addParksInside(context->plateDict, line->plateId, -1);
+    }
+    else {
+        line->type = EVENT_ENTRY;
+        *mask |= 1u << p;
+        scan->availableSpots[p]--;
+        addParksInside(context->plateDict, line->plateId, 1);
+    }
+    line->occupancy =
+        *getCapacity(scan->parks[p]) - scan->availableSpots[p];
+
+    copyTimestamp(context->lastTimestamp, &line->timestamp);
+    if (hasEventId){
+        dedupeInsert(context->dedupeFilter, eventId,
+                    timestampToMinutes(context->lastTimestamp));
+    }
+}
+
+
+/**
+ * @brief Registers the applied lines of one park, in input order (body of
+ * a parallel for).
+ *
+ * @param parkReplays The array of ParkReplay.
+ * @param i Index of the park.
+ */
+void applyParkLines(void* parkReplays, unsigned int i){
+    ParkReplay* replay = &((ParkReplay*)parkReplays)[i];
+
+    for (unsigned int k = 0; k < replay->numLines; k++){
+        ReplayLine* line = &replay->lines[replay->lineIndexes[k]];
+        Log* log = registerEntryExit(replay->park, replay->passes,
+                        line->plate, line->plateId,
+                        getOpenLog(replay->park, line->plateId),
+                        &line->timestamp, replay->tracer);
+        line->log = log;
+
+        line->offset = ftell(replay->out.stream);
+        if (line->type == EVENT_ENTRY){
+            outputEntry(&replay->out, getParkName(replay->park),
+                        *getAvailableSpots(replay->park));
+        }
+        else {
+            line->cost = getLogCost(log);
+            outputExit(&replay->out, log, line->cost);
+        }
+        line->length = ftell(replay->out.stream) - line->offset;
+    }
+    fclose(replay->out.stream);
+}
+
+
+/**
+ * @brief Processes the lines of a replay segment, then empties it.
+ *
+ * The outcome of every line is decided first, in input order. The applied
+ * lines are then registered in their parks in parallel, and finally the
+ * entries are chained to their plates' visits, the subscribers notified
+ * and the answers written, in input order.
+ *
+ * @param segment Pointer to the replay segment.
+ * @param context Pointer to the replay context.
+ */
+void replaySegment(ReplaySegment* segment, const ReplayContext* context){
+    ReplayScan scan;
+    ParkReplay parkReplays[MAX_PARKS];
+    char* buffers[MAX_PARKS + 1];
+
+    // Phase 1: decide the outcome of each line
+    SpanStart start = traceBegin(context->tracer);
+    startScan(&scan, context);
+    for (unsigned int i = 0; i < segment->numLines; i++){
+        scanLine(&scan, context, &segment->lines[i]);
+    }
+    fclose(scan.errors.stream);
+    free(scan.parkMasks);
+    buffers[scan.numParks] = scan.buffer;
+    traceEnd(context->tracer, "replay scan", &start);
+
+    // Phase 2: register the applied lines, each park in parallel
+    start = traceBegin(context->tracer);
+    for (unsigned int p = 0; p < scan.numParks; p++){
+        parkReplays[p].park = scan.parks[p];
+        parkReplays[p].lines = segment->lines;
+        parkReplays[p].tracer = context->tracer;
+        parkReplays[p].passes = context->passes;
+        parkReplays[p].numLines = 0;
+        parkReplays[p].lineIndexes = (unsigned int*)malloc(
+                                segment->numLines * sizeof(unsigned int) + 1);
+        parkReplays[p].out.binary = context->out->binary;
+        parkReplays[p].out.stream = open_memstream(&parkReplays[p].buffer,
+                                        &parkReplays[p].bufferSize);
+    }
+    for (unsigned int i = 0; i < segment->numLines; i++){
+        ReplayLine* line = &segment->lines[i];
+        if (line->outcome == REPLAY_APPLIED){
+            ParkReplay* replay = &parkReplays[line->parkIndex];
+            replay->lineIndexes[replay->numLines++] = i;
+        }
+    }
+    parallelFor(context->scheduler, 0, scan.numParks, 1, applyParkLines,
+                parkReplays);
+    traceEnd(context->tracer, "replay apply", &start);
+
+    // Phase 3: index, notify and answer in input order
+    start = traceBegin(context->tracer);
+    for (unsigned int p = 0; p < scan.numParks; p++){
+        buffers[p] = parkReplays[p].buffer;
+        free(parkReplays[p].lineIndexes);
+    }
+    for (unsigned int i = 0; i < segment->numLines; i++){
+        ReplayLine* line = &segment->lines[i];
+        if (line->outcome == REPLAY_APPLIED){
+            Park* park = scan.parks[line->parkIndex];
+            // Parks move in input order, so ties rank as without replay
+            updateAvailability(context->availability, park,
+                                *getCapacity(park) - line->occupancy);
+            recordGroupEntryExit(park, line->type == EVENT_ENTRY,
+                                    line->cost);
+            // The plates' chains of visits are shared by the parks
+            if (line->type == EVENT_ENTRY){
+                addPlateVisit(context->plateDict, line->plateId, line->log);
+            }
+            publishEntryExit(context->eventBus, line->type, line->plateId,
+                line->plate, getParkName(park), line->occupancy,
+                &line->timestamp);
+        }
+        if (line->outcome != REPLAY_DROPPED){
+            outputBytes(context->out, buffers[line->buffer] + line->offset,
+                        line->length);
+        }
+        free(line->text);
+    }
+    for (unsigned int p = 0; p <= scan.numParks; p++){
+        free(buffers[p]);
+    }
+    segment->numLines = 0;
+    traceEnd(context->tracer, "replay write", &start);
+}
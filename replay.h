@@ -0,0 +1,105 @@
+/**
+ * Definition of the replay structs, and of the function prototypes related
+ * to them.
+ *
+ * A replay processes a run of entries/exits of an event file in two
+ * phases. The first scans the lines in order and decides each outcome from
+ * a compact state: the available spots of each park, the mask of parks each
+ * plate is inside, the last timestamp and the retried event ids. The second
+ * applies the accepted lines to the parks in parallel, one task per park,
+ * each writing its answers to its own buffer. The answers are then written
+ * in input order, so the output is the same as processing the lines one by
+ * one.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "dedupe.h"
+#include "events.h"
+#include "output.h"
+#include "park.h"
+#include "platedict.h"
+#include "scheduler.h"
+#include "trace.h"
+
+// Maximum number of lines of a segment
+#define REPLAY_SEGMENT_LINES 65536
+
+// Outcomes of a line
+#define REPLAY_DROPPED 0 // retried event id, no answer
+#define REPLAY_REJECTED 1 // answered with an error
+#define REPLAY_APPLIED 2 // registered in a park
+
+typedef struct replayLine {
+    char* text; // the command line
+    int outcome; // REPLAY_*
+    char type; // EVENT_ENTRY or EVENT_EXIT, if applied
+    unsigned int parkIndex; // position of the park in the list, if applied
+    unsigned int plateId;
+    char plate[PLATE_LENGTH];
+    Timestamp timestamp;
+    int occupancy; // occupied spots of the park after the line
+    double cost; // cost of the stay, if applied as an exit
+    Log* log; // log of the entry/exit, if applied
+    unsigned int buffer; // buffer holding the answer to the line
+    long offset; // position of the answer in its buffer
+    long length; // length of the answer
+} ReplayLine;
+
+typedef struct parkReplay {
+    Park* park;
+    ReplayLine* lines; // lines of the segment
+    unsigned int* lineIndexes; // applied lines of this park, in input order
+    unsigned int numLines;
+    const PassSet* passes; // global passes
+    Output out; // buffer of this park's answers
+    char* buffer;
+    size_t bufferSize;
+    Tracer* tracer;
+} ParkReplay;
+
+typedef struct replaySegment {
+    ReplayLine* lines;
+    unsigned int numLines;
+} ReplaySegment;
+
+typedef struct replayScan {
+    Park* parks[MAX_PARKS]; // parks by position in the list
+    unsigned int numParks;
+    int availableSpots[MAX_PARKS]; // available spots after the scanned lines
+    unsigned int* parkMasks; // bit i set if the plate is inside parks[i]
+    unsigned int masksSize; // allocated length of parkMasks
+    Output errors; // buffer of the errors of rejected lines
+    char* buffer;
+    size_t bufferSize;
+} ReplayScan;
+
+typedef struct replayContext {
+    Park* headPark;
+    PlateDict* plateDict;
+    EventBus* eventBus;
+    DedupeFilter* dedupeFilter;
+    AvailabilityIndex* availability;
+    const PassSet* passes; // global passes
+    Timestamp* lastTimestamp;
+    const Output* out;
+    Scheduler* scheduler;
+    Tracer* tracer; // NULL if tracing is disabled
+} ReplayContext;
+
+
+// Initializer
+ReplaySegment* newReplaySegment();
+
+// Free
+void freeReplaySegment(ReplaySegment* segment);
+
+// Segment building
+int replaySegmentFull(const ReplaySegment* segment);
+void addReplayLine(ReplaySegment* segment, const char* line);
+
+// Processing
+void replaySegment(ReplaySegment* segment, const ReplayContext* context);
+#endif
@@ -0,0 +1,187 @@
+/**
+ * Implementation of the functions related to billing reports.
+ *
+ * A billing report prints a park's billing a few exits at a time, and can
+ * be resumed between other commands.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include "report.h"
+
+// Number of steps that runs any report to completion
+#define ALL_STEPS 0xFFFFFFFFu
+
+
+/**
+ * @brief Creates a billing report of a park.
+ *
+ * If the date is the INITIAL_TIMESTAMP the report prints the total billed
+ * in each day since the park's creation. Otherwise it prints the bill of
+ * each exit in the given day.
+ *
+ * @param park Pointer to the park.
+ * @param date Pointer to the day to list, or to INITIAL_TIMESTAMP.
+ * @param out Pointer to the output where the report is written.
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
+ * @return Pointer to the new billing report.
+ */
+BillingReport* newBillingReport(Park* park, const Timestamp* date,
+const Output* out, Tracer* tracer){
+    BillingReport* report = (BillingReport*)malloc(sizeof(BillingReport));
+
+    report->park = park;
+    report->out = out;
+    report->tracer = tracer;
+    copyTimestamp(&report->date, date);
+    report->nextExit = 0;
+    report->endExit = getNumExits(park);
+    if (!isInitialTimestamp(date)){
+        // Only the exits of the given day
+        report->nextExit = findFirstExit(park, date);
+        report->endExit = findExitAfter(park, date);
+    }
+    report->nextLog = (report->nextExit < report->endExit) ?
+                        getExitAtIndex(park, report->nextExit) : NULL;
+    report->currentDay = INITIAL_TIMESTAMP;
+    report->bill = 0;
+    report->next = NULL;
+
+    return report;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a billing report.
+ *
+ * @param report Pointer to the billing report.
+ */
+void freeBillingReport(BillingReport* report){
+    free(report);
+}
+
+
+/**
+ * @brief Adds an exit's cost to the summary, printing the previous day's
+ * total when the exit is on a new day.
+ *
+ * @param report Pointer to the billing report.
+ * @param log Pointer to the log of the exit.
+ * @param cost The cost of the stay.
+ */
+void sumExit(BillingReport* report, Log* log, double cost){
+    Timestamp* exitTimestamp = getExitTimestamp(log);
+
+    if (!isInitialTimestamp(&report->currentDay) &&
+        compareDate(&report->currentDay, exitTimestamp) != 0){
+        outputDayBill(report->out, &report->currentDay, report->bill);
+        report->bill = 0;
+    }
+    if (isInitialTimestamp(&report->currentDay) ||
+        compareDate(&report->currentDay, exitTimestamp) != 0){
+        copyTimestamp(&report->currentDay, exitTimestamp);
+    }
+
+    report->bill += cost;
+}
+
+
+/**
+ * @brief Resumes a billing report, processing at most the given number of
+ * exits.
+ *
+ * The costs are the ones billed at the exits (see calculateStayCost), so
+ * passes and corrections are honoured as they were when billing.
+ *
+ * @param report Pointer to the billing report.
+ * @param steps Maximum number of exits to process.
+ * @return 1 if the report is finished, 0 otherwise.
+ */
+int advanceBillingReport(BillingReport* report, unsigned int steps){
+    int summary = isInitialTimestamp(&report->date);
+    unsigned int count = report->endExit - report->nextExit;
+
+    if (steps < count){
+        count = steps;
+    }
+
+    SpanStart start = traceBegin(report->tracer);
+    for (unsigned int i = 0; i < count; i++){
+        Log* log = report->nextLog;
+        report->nextLog = getNextExit(report->park, log);
+        report->nextExit++;
+        if (summary)
+            sumExit(report, log, getLogCost(log));
+        else
+            outputBill(report->out, log, getLogCost(log));
+    }
+    traceEnd(report->tracer, "report write", &start);
+
+    if (report->nextExit < report->endExit){
+        return 0;
+    }
+    // The last day of the summary can only be printed at the end
+    if (summary && !isInitialTimestamp(&report->currentDay)){
+        outputDayBill(report->out, &report->currentDay, report->bill);
+    }
+    outputEnd(report->out);
+    return 1;
+}
+
+
+/**
+ * @brief Adds a billing report to the end of a queue of reports.
+ *
+ * @param queue Pointer to the head of the queue.
+ * @param report Pointer to the billing report.
+ */
+void enqueueReport(BillingReport** queue, BillingReport* report){
+    while (*queue != NULL){
+        queue = &(*queue)->next;
+    }
+    *queue = report;
+}
+
+
+/**
+ * @brief Resumes the report at the head of a queue, removing it once it is
+ * finished.
+ *
+ * Reports are printed one after the other, by the order of their commands.
+ *
+ * @param queue Pointer to the head of the queue.
+ * @param steps Maximum number of exits to process.
+ */
+void advanceReports(BillingReport** queue, unsigned int steps){
+    if (*queue != NULL && advanceBillingReport(*queue, steps)){
+        BillingReport* finished = *queue;
+        *queue = finished->next;
+        freeBillingReport(finished);
+    }
+}
+
+
+/**
+ * @brief Finishes every report of the queue up to the last report of a
+ * park (or every report, if park is NULL).
+ *
+ * Used before a park is removed, as its reports point to it. Earlier
+ * reports are finished first to keep the output in order.
+ *
+ * @param queue Pointer to the head of the queue.
+ * @param park Pointer to the park, or NULL.
+ */
+void finishParkReports(BillingReport** queue, const Park* park){
+    unsigned int toFinish = 0, position = 0;
+
+    for (BillingReport* r = *queue; r != NULL; r = r->next){
+        position++;
+        if (park == NULL || r->park == park)
+            toFinish = position;
+    }
+
+    for (; toFinish > 0; toFinish--){
+        advanceReports(queue, ALL_STEPS);
+    }
+}
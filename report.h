@@ -0,0 +1,47 @@
+/**
+ * Definition of the billing report struct, and of the function prototypes
+ * related to it.
+ *
+ * A billing report prints a park's billing ('f' command) a few exits at a
+ * time. Its state records where it stopped, so it can be resumed between
+ * other commands instead of blocking them until the whole report is out.
+ * The report only covers the exits registered when it was created.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef REPORT_H
+#define REPORT_H
+
+#include "output.h"
+#include "park.h"
+#include "trace.h"
+
+typedef struct billingReport {
+    Park* park;
+    const Output* out; // where the report is written
+    Tracer* tracer; // records the spans of the report, or NULL
+    Timestamp date; // day to list, or INITIAL_TIMESTAMP for the summary
+    unsigned int nextExit; // position of the next exit to process
+    unsigned int endExit; // position after the last exit to process
+    Log* nextLog; // log of the exit at nextExit, if there's one to process
+    Timestamp currentDay; // day being summed (summary only)
+    double bill; // total of currentDay so far (summary only)
+    struct billingReport* next; // next report waiting to be resumed
+} BillingReport;
+
+
+// Initializer
+BillingReport* newBillingReport(Park* park, const Timestamp* date,
+                                const Output* out, Tracer* tracer);
+
+// Free
+void freeBillingReport(BillingReport* report);
+
+// Resuming
+int advanceBillingReport(BillingReport* report, unsigned int steps);
+
+// Queue of reports being resumed
+void enqueueReport(BillingReport** queue, BillingReport* report);
+void advanceReports(BillingReport** queue, unsigned int steps);
+void finishParkReports(BillingReport** queue, const Park* park);
+#endif
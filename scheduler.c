@@ -0,0 +1,341 @@
+/**
+ * Implementation of the functions related to the scheduler.
+ *
+ * The scheduler runs the tasks of batch jobs on a fixed number of workers,
+ * each with its own deque, stealing from the others when idle.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <sched.h>
+#include <stdlib.h>
+#include "scheduler.h"
+
+void* workerLoop(void* start);
+
+
+/**
+ * @brief Creates a scheduler, starting its worker threads.
+ *
+ * @param numWorkers Number of workers, counting the calling thread (>= 1).
+ * @return Pointer to the new scheduler.
+ */
+Scheduler* newScheduler(int numWorkers){
+    Scheduler* scheduler = (Scheduler*)malloc(sizeof(Scheduler));
+
+    scheduler->numWorkers = numWorkers;
+    scheduler->deques = (TaskDeque*)malloc(numWorkers * sizeof(TaskDeque));
+    scheduler->threads = (pthread_t*)malloc(numWorkers * sizeof(pthread_t));
+    atomic_init(&scheduler->queued, 0);
+    atomic_init(&scheduler->running, 1);
+    pthread_mutex_init(&scheduler->idleLock, NULL);
+    pthread_cond_init(&scheduler->idle, NULL);
+
+    for (int i = 0; i < numWorkers; i++){
+        TaskDeque* deque = &scheduler->deques[i];
+        deque->capacity = INITIAL_DEQUE_CAPACITY;
+        deque->tasks = (Task*)malloc(deque->capacity * sizeof(Task));
+        deque->top = deque->bottom = 0;
+        pthread_mutex_init(&deque->lock, NULL);
+    }
+
+    scheduler->threads[0] = pthread_self();
+    for (int i = 1; i < numWorkers; i++){
+        WorkerStart* start = (WorkerStart*)malloc(sizeof(WorkerStart));
+        start->scheduler = scheduler;
+        start->index = i;
+        pthread_create(&scheduler->threads[i], NULL, workerLoop, start);
+    }
+
+    return scheduler;
+}
+
+
+/**
+ * @brief Stops the workers of a scheduler and frees its memory.
+ *
+ * Every task must have been waited for.
+ *
+ * @param scheduler Pointer to the scheduler.
+ */
+void freeScheduler(Scheduler* scheduler){
+    pthread_mutex_lock(&scheduler->idleLock);
+    atomic_store(&scheduler->running, 0);
+    pthread_cond_broadcast(&scheduler->idle);
+    pthread_mutex_unlock(&scheduler->idleLock);
+
+    for (int i = 1; i < scheduler->numWorkers; i++){
+        pthread_join(scheduler->threads[i], NULL);
+    }
+    for (int i = 0; i < scheduler->numWorkers; i++){
+        free(scheduler->deques[i].tasks);
+        pthread_mutex_destroy(&scheduler->deques[i].lock);
+    }
+    pthread_mutex_destroy(&scheduler->idleLock);
+    pthread_cond_destroy(&scheduler->idle);
+    free(scheduler->deques);
+    free(scheduler->threads);
+    free(scheduler);
+}
+
+
+/**
+ * @brief Retrieves the number of workers of a scheduler.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @return The number of workers.
+ */
+int getNumWorkers(const Scheduler* scheduler){
+    return scheduler->numWorkers;
+}
+
+
+/**
+ * @brief Finds the worker running in the calling thread.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @return Index of the worker.
+ */
+int currentWorker(const Scheduler* scheduler){
+    pthread_t self = pthread_self();
+
+    for (int i = 1; i < scheduler->numWorkers; i++){
+        if (pthread_equal(scheduler->threads[i], self)){
+            return i;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Pushes a task at the bottom of a deque, growing it if full.
+ *
+ * @param deque Pointer to the deque.
+ * @param task Pointer to the task.
+ */
+void pushBottom(TaskDeque* deque, const Task* task){
+    pthread_mutex_lock(&deque->lock);
+    if (deque->bottom - deque->top == deque->capacity){
+        Task* tasks = (Task*)malloc(2 * deque->capacity * sizeof(Task));
+        for (unsigned int i = deque->top; i != deque->bottom; i++){
+            tasks[i & (2 * deque->capacity - 1)] =
+                deque->tasks[i & (deque->capacity - 1)];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity *= 2;
+    }
+    deque->tasks[deque->bottom++ & (deque->capacity - 1)] = *task;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+
+/**
+ * @brief Takes a task from a deque, the newest (bottom) for its owner or
+ * the oldest (top) for a thief.
+ *
+ * @param deque Pointer to the deque.
+ * @param task Where to store the task.
+ * @param steal 1 to take from the top, 0 to take from the bottom.
+ * @return 1 if a task was taken, 0 if the deque was empty.
+ */
+int takeTask(TaskDeque* deque, Task* task, int steal){
+    int taken = 0;
+
+    pthread_mutex_lock(&deque->lock);
+    if (deque->top != deque->bottom){
+        unsigned int position = steal ? deque->top++ : --deque->bottom;
+        *task = deque->tasks[position & (deque->capacity - 1)];
+        taken = 1;
+    }
+    pthread_mutex_unlock(&deque->lock);
+
+    return taken;
+}
+
+
+/**
+ * @brief Finds a task for a worker, first in its own deque, then stealing
+ * from the others.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @param worker Index of the worker.
+ * @param task Where to store the task.
+ * @return 1 if a task was found, 0 otherwise.
+ */
+int findTask(Scheduler* scheduler, int worker, Task* task){
+    if (takeTask(&scheduler->deques[worker], task, 0)){
+        return 1;
+    }
+    for (int i = 1; i < scheduler->numWorkers; i++){
+        int victim = (worker + i) % scheduler->numWorkers;
+        if (takeTask(&scheduler->deques[victim], task, 1)){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @brief Runs a task, then marks it as finished in its group.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @param task Pointer to the task.
+ */
+void runTask(Scheduler* scheduler, const Task* task){
+    atomic_fetch_sub(&scheduler->queued, 1);
+    task->run(task->arg);
+    atomic_fetch_sub(task->pending, 1);
+}
+
+
+/**
+ * @brief Main loop of a worker thread: runs tasks, sleeping while there
+ * are none, until the scheduler is freed.
+ *
+ * @param start Pointer to the WorkerStart of the worker (freed here).
+ * @return NULL.
+ */
+void* workerLoop(void* start){
+    Scheduler* scheduler = ((WorkerStart*)start)->scheduler;
+    int worker = ((WorkerStart*)start)->index;
+    Task task;
+
+    free(start);
+    while (atomic_load(&scheduler->running)){
+        if (findTask(scheduler, worker, &task)){
+            runTask(scheduler, &task);
+            continue;
+        }
+        pthread_mutex_lock(&scheduler->idleLock);
+        while (atomic_load(&scheduler->queued) == 0 &&
+                atomic_load(&scheduler->running)){
+            pthread_cond_wait(&scheduler->idle, &scheduler->idleLock);
+        }
+        pthread_mutex_unlock(&scheduler->idleLock);
+    }
+
+    return NULL;
+}
+
+
+/**
+ * @brief Spawns a task in the calling worker's deque.
+ *
+ * With a single worker the task runs immediately.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @param pending Counter of the group of the task, incremented now and
+ * decremented when the task finishes.
+ * @param run Function run by the task.
+ * @param arg Argument of the function.
+ */
+void spawnTask(Scheduler* scheduler, atomic_int* pending,
+void (*run)(void* arg), void* arg){
+    if (scheduler->numWorkers == 1){
+        run(arg);
+        return;
+    }
+    Task task = {run, arg, pending};
+
+    atomic_fetch_add(pending, 1);
+    atomic_fetch_add(&scheduler->queued, 1);
+    pushBottom(&scheduler->deques[currentWorker(scheduler)], &task);
+
+    pthread_mutex_lock(&scheduler->idleLock);
+    pthread_cond_signal(&scheduler->idle);
+    pthread_mutex_unlock(&scheduler->idleLock);
+}
+
+
+/**
+ * @brief Waits until every task of a group is finished, running tasks
+ * (its own or stolen) in the meantime.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @param pending Counter of the group.
+ */
+void waitTasks(Scheduler* scheduler, atomic_int* pending){
+    int worker = currentWorker(scheduler);
+    Task task;
+
+    while (atomic_load(pending) > 0){
+        if (findTask(scheduler, worker, &task)){
+            runTask(scheduler, &task);
+        }
+        else {
+            sched_yield();
+        }
+    }
+}
+
+
+/**
+ * @brief Runs two functions, possibly in parallel, returning once both are
+ * finished.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @param first The first function, run by the calling thread.
+ * @param firstArg Argument of the first function.
+ * @param second The second function, which may be stolen by other workers.
+ * @param secondArg Argument of the second function.
+ */
+void forkJoin(Scheduler* scheduler, void (*first)(void* arg), void* firstArg,
+void (*second)(void* arg), void* secondArg){
+    atomic_int pending;
+
+    atomic_init(&pending, 0);
+    spawnTask(scheduler, &pending, second, secondArg);
+    first(firstArg);
+    waitTasks(scheduler, &pending);
+}
+
+
+/**
+ * @brief Runs a range of a parallel for, splitting it in halves until they
+ * are at most grain iterations long.
+ *
+ * @param rangeTask Pointer to the RangeTask.
+ */
+void runRange(void* rangeTask){
+    RangeTask* range = (RangeTask*)rangeTask;
+
+    if (range->end - range->begin <= range->grain){
+        for (unsigned int i = range->begin; i < range->end; i++){
+            range->body(range->arg, i);
+        }
+        return;
+    }
+
+    unsigned int middle = range->begin + (range->end - range->begin) / 2;
+    RangeTask low = *range, high = *range;
+    low.end = middle;
+    high.begin = middle;
+    forkJoin(range->scheduler, runRange, &low, runRange, &high);
+}
+
+
+/**
+ * @brief Calls body(arg, i) for every i in [begin, end), in parallel.
+ *
+ * The calls may run in any order, so they must be independent.
+ *
+ * @param scheduler Pointer to the scheduler.
+ * @param begin First iteration.
+ * @param end Iteration after the last one.
+ * @param grain Iterations below which a range is no longer split (>= 1).
+ * @param body Function called for each iteration.
+ * @param arg First argument of body.
+ */
+void parallelFor(Scheduler* scheduler, unsigned int begin, unsigned int end,
+unsigned int grain, void (*body)(void* arg, unsigned int i), void* arg){
+    RangeTask range = {scheduler, begin, end, grain, body, arg};
+
+    if (scheduler->numWorkers == 1){
+        range.grain = (end > begin) ? end - begin : 1;
+    }
+    if (begin < end){
+        runRange(&range);
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * Definition of the scheduler structs, and of the function prototypes
+ * related to them.
+ *
+ * The scheduler runs the tasks of batch jobs on a fixed number of workers.
+ * Each worker has its own deque of tasks: it pushes and pops the tasks it
+ * spawns at the bottom, and steals from the top of the other deques when
+ * its own is empty. The thread that creates the scheduler is worker 0, and
+ * only runs tasks while it waits for them. With a single worker every task
+ * runs in place, and no thread is created.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Initial number of tasks each deque can hold
+#define INITIAL_DEQUE_CAPACITY 64
+
+typedef struct task {
+    void (*run)(void* arg);
+    void* arg;
+    atomic_int* pending; // tasks of the group not finished yet
+} Task;
+
+typedef struct taskDeque {
+    Task* tasks; // circular array
+    unsigned int top; // position of the oldest task (stolen first)
+    unsigned int bottom; // position after the newest task
+    unsigned int capacity; // always a power of 2
+    pthread_mutex_t lock;
+} TaskDeque;
+
+typedef struct scheduler {
+    int numWorkers;
+    TaskDeque* deques; // one per worker
+    pthread_t* threads; // thread of each worker (threads[0] is the creator)
+    atomic_int queued; // tasks waiting in the deques
+    atomic_int running; // 0 once the workers must stop
+    pthread_mutex_t idleLock;
+    pthread_cond_t idle; // signaled when a task is queued
+} Scheduler;
+
+typedef struct rangeTask {
+    Scheduler* scheduler;
+    unsigned int begin, end, grain;
+    void (*body)(void* arg, unsigned int i);
+    void* arg;
+} RangeTask;
+
+typedef struct workerStart {
+    Scheduler* scheduler;
+    int index; // index of the worker started
+} WorkerStart;
+
+
+// Initializer
+Scheduler* newScheduler(int numWorkers);
+
+// Free
+void freeScheduler(Scheduler* scheduler);
+
+// Getters
+int getNumWorkers(const Scheduler* scheduler);
+
+// Fork/join
+void spawnTask(Scheduler* scheduler, atomic_int* pending,
+                void (*run)(void* arg), void* arg);
+void waitTasks(Scheduler* scheduler, atomic_int* pending);
+void forkJoin(Scheduler* scheduler, void (*first)(void* arg), void* firstArg,
+                void (*second)(void* arg), void* secondArg);
+void parallelFor(Scheduler* scheduler, unsigned int begin, unsigned int end,
+                unsigned int grain, void (*body)(void* arg, unsigned int i),
+                void* arg);
+#endif
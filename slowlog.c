@@ -0,0 +1,144 @@
+/**
+ * Implementation of the functions related to the slow log.
+ *
+ * Commands slower than the threshold are written, one per line, with
+ * their park, hashtable probe and output size.
+ *
+ * Author: Adolfo Monteiro
+*/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "slowlog.h"
+#include "trace.h"
+
+// Nanoseconds in a microsecond
+#define NANOSECONDS_PER_MICROSECOND 1000ull
+
+
+/**
+ * @brief Writes bytes to the real stdout, counting them (write function of
+ * the stream installed as stdout).
+ *
+ * @param cookie Pointer to the slow log.
+ * @param buffer The bytes.
+ * @param size Number of bytes.
+ * @return Number of bytes written.
+ */
+ssize_t writeCounted(void* cookie, const char* buffer, size_t size){
+    SlowLog* log = (SlowLog*)cookie;
+    size_t n = fwrite(buffer, 1, size, log->target);
+
+    log->written += n;
+    return (ssize_t)n;
+}
+
+
+/**
+ * @brief Creates a slow log, installing the counting stream as stdout.
+ *
+ * @param thresholdMicroseconds Microseconds from which a command is slow
+ * (0 records every command).
+ * @param records Where to write the slow commands.
+ * @return Pointer to the new slow log.
+ */
+SlowLog* newSlowLog(int thresholdMicroseconds, FILE* records){
+    SlowLog* log = (SlowLog*)malloc(sizeof(SlowLog));
+    cookie_io_functions_t functions = {NULL, writeCounted, NULL, NULL};
+
+    log->threshold =
+        (unsigned long long)thresholdMicroseconds * NANOSECONDS_PER_MICROSECOND;
+    log->records = records;
+    log->target = stdout;
+    log->written = 0;
+    log->numRecords = 0;
+    log->counter = fopencookie(log, "w", functions);
+    stdout = log->counter;
+
+    return log;
+}
+
+
+/**
+ * @brief Restores the real stdout and frees a slow log.
+ *
+ * @param log Pointer to the slow log.
+ */
+void freeSlowLog(SlowLog* log){
+    fclose(log->counter);
+    stdout = log->target;
+    fprintf(log->records, "slow log: %lu commands over %llu us\n",
+            log->numRecords, log->threshold / NANOSECONDS_PER_MICROSECOND);
+    free(log);
+}
+
+
+/**
+ * @brief Marks the start of a command.
+ *
+ * @param log Pointer to the slow log.
+ * @return The start of the command.
+ */
+SlowCommand startSlowCommand(SlowLog* log){
+    SlowCommand command = {clockNanoseconds(), log->written};
+
+    return command;
+}
+
+
+/**
+ * @brief Marks the end of a command, measuring it.
+ *
+ * The output of the command is flushed to the real stdout (after its time
+ * is taken), so its bytes are counted.
+ *
+ * @param log Pointer to the slow log.
+ * @param command Pointer to the start of the command.
+ * @param nanoseconds Where to store the time taken by the command.
+ * @param written Where to store the bytes the command wrote to stdout.
+ * @return 1 if the command is slow, 0 otherwise.
+ */
+int endSlowCommand(SlowLog* log, const SlowCommand* command,
+unsigned long long* nanoseconds, unsigned long long* written){
+    *nanoseconds = clockNanoseconds() - command->start;
+    fflush(log->counter);
+    *written = log->written - command->written;
+    return *nanoseconds >= log->threshold;
+}
+
+
+/**
+ * @brief Writes a slow command to the slow log.
+ *
+ * A record is a line of fields: time taken (microseconds), command letter,
+ * park ("-" if none), hashtable size and logs, chain walked by the last
+ * lookup or insertion ("-" without a park), bytes written, and the command
+ * itself.
+ *
+ * @param log Pointer to the slow log.
+ * @param line The command line.
+ * @param parkName The park of the command, or NULL if none.
+ * @param table The log hashtable of the park, or NULL if it has none.
+ * @param written Bytes the command wrote to stdout.
+ * @param nanoseconds Time taken by the command.
+ */
+void recordSlowCommand(SlowLog* log, const char* line, const char* parkName,
+const Hashtable* table, unsigned long long written,
+unsigned long long nanoseconds){
+    int length = (int)strcspn(line, "\n");
+    char command = length > 0 ? line[0] : '-';
+
+    fprintf(log->records, "slow %.3f us command %c park %s",
+            nanoseconds / (double)NANOSECONDS_PER_MICROSECOND, command,
+            parkName != NULL ? parkName : "-");
+    if (table != NULL){
+        fprintf(log->records, " table %d/%u chain %u", getSize(table),
+                getNumElements(table), getLastChainLength(table));
+    }
+    else{
+        fprintf(log->records, " table - chain -");
+    }
+    fprintf(log->records, " output %llu line %.*s\n", written, length, line);
+    log->numRecords++;
+}
@@ -0,0 +1,52 @@
+/**
+ * Definition of the slow log struct, and of the function prototypes
+ * related to it.
+ *
+ * The slow log records every command that takes longer than a threshold,
+ * with what it touched: its park, the size of the park's log hashtable
+ * and the chain walked by its last lookup, and the bytes it wrote. Rare
+ * stalls (a hashtable resize, a huge report) then show up with their
+ * cause.
+ *
+ * The bytes written are counted by a stream installed as stdout, which
+ * writes through to the real one (the GNU C Library lets stdout be
+ * assigned).
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef SLOWLOG_H
+#define SLOWLOG_H
+
+#include <stdio.h>
+#include "hashtable.h"
+
+typedef struct slowLog {
+    unsigned long long threshold; // nanoseconds from which a command is slow
+    FILE* records; // where the slow commands are written
+    FILE* target; // the real stdout
+    FILE* counter; // stream installed as stdout, counting into written
+    unsigned long long written; // bytes written to stdout so far
+    unsigned long numRecords;
+} SlowLog;
+
+typedef struct slowCommand {
+    unsigned long long start; // clock reading when the command started
+    unsigned long long written; // bytes written to stdout before it
+} SlowCommand;
+
+
+// Initializer
+SlowLog* newSlowLog(int thresholdMicroseconds, FILE* records);
+
+// Free
+void freeSlowLog(SlowLog* log);
+
+// Recording
+SlowCommand startSlowCommand(SlowLog* log);
+int endSlowCommand(SlowLog* log, const SlowCommand* command,
+                    unsigned long long* nanoseconds,
+                    unsigned long long* written);
+void recordSlowCommand(SlowLog* log, const char* line, const char* parkName,
+                        const Hashtable* table, unsigned long long written,
+                        unsigned long long nanoseconds);
+#endif
@@ -5,8 +5,19 @@
  * 
  * Author: Adolfo Monteiro
 */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "tariff.h"
 
+// Length of the buffer of a word of the rules (keyword or days)
+#define TARIFF_WORD_LENGTH 16
+// Maximum number of characters of a word of the rules, for scanf
+#define TARIFF_WORD_WIDTH "15"
+
+// Names of the weekdays in the rules, from Monday
+const char* WEEKDAY_NAMES[] = {"mon", "tue", "wed", "thu", "fri", "sat", "sun"};
+
 
 /**
  * @brief Creates a new tariff instance.
@@ -25,17 +36,215 @@ const double* valueMaxDaily){
     theTariff.value15 = *value15;
     theTariff.value15after1 = *value15after1;
     theTariff.valueMaxDaily = *valueMaxDaily;
+    theTariff.tables = NULL;
+    theTariff.invalidRules = 0;
 
     return theTariff;
 }
 
 
+/**
+ * @brief Finds a weekday by its name.
+ * 
+ * @param name The name of the weekday (see WEEKDAY_NAMES).
+ * @param length Length of the name.
+ * @return The weekday (0 is Monday), or -1 if there's no such weekday.
+ */
+int findWeekday(const char* name, unsigned int length){
+    for (int day = 0; day < DAYS_IN_WEEK; day++){
+        if (length == strlen(WEEKDAY_NAMES[day]) &&
+            strncmp(name, WEEKDAY_NAMES[day], length) == 0){
+            return day;
+        }
+    }
+    return -1;
+}
+
+
+/**
+ * @brief Parses the days of a rule: a weekday, a range of weekdays (which
+ * may wrap around the week, as in sat-mon) or all.
+ * 
+ * @param days The days of the rule.
+ * @param first Where to store the first weekday.
+ * @param last Where to store the last weekday.
+ * @return 1 if the days are valid, 0 otherwise.
+ */
+int parseWeekdays(const char* days, int* first, int* last){
+    const char* dash = strchr(days, '-');
+
+    if (strcmp(days, "all") == 0){
+        *first = 0;
+        *last = DAYS_IN_WEEK - 1;
+        return 1;
+    }
+    if (dash == NULL){
+        *first = *last = findWeekday(days, strlen(days));
+    }
+    else {
+        *first = findWeekday(days, dash - days);
+        *last = findWeekday(dash + 1, strlen(dash + 1));
+    }
+    return *first >= 0 && *last >= 0;
+}
+
+
+/**
+ * @brief Sets the rates of the quarters starting in a window of some
+ * weekdays.
+ * 
+ * The rates of the later quarters are kept in laterSums, until they are
+ * summed by sumLaterRates.
+ * 
+ * @param tables Pointer to the tables being compiled.
+ * @param first The first weekday.
+ * @param last The last weekday.
+ * @param start Minute of the day the window starts.
+ * @param end Minute of the day the window ends (of the next day if it's
+ * not after the start).
+ * @param firstRate Rate of the quarters of the 1st hour.
+ * @param laterRate Rate of the later quarters.
+ */
+void setRates(TariffTables* tables, int first, int last, int start, int end,
+double firstRate, double laterRate){
+    if (end <= start){
+        end += MINUTES_IN_DAY;
+    }
+    for (int day = first; ; day = (day + 1) % DAYS_IN_WEEK){
+        int dayStart = day * (MINUTES_IN_DAY);
+        for (int minute = dayStart + start; minute < dayStart + end; minute++){
+            tables->first[minute % MINUTES_IN_WEEK] = firstRate;
+            tables->laterSums[minute % MINUTES_IN_WEEK] = laterRate;
+        }
+        if (day == last){
+            break;
+        }
+    }
+}
+
+
+/**
+ * @brief Turns the rates of the later quarters into their prefix sums.
+ * 
+ * The rates of the week are repeated for the next day, so a day of stay
+ * starting late in the week doesn't wrap around the table.
+ * 
+ * @param tables Pointer to the tables being compiled.
+ */
+void sumLaterRates(TariffTables* tables){
+    for (int i = MINUTES_IN_WEEK; i < TARIFF_SUMS_LENGTH; i++){
+        tables->laterSums[i] = tables->laterSums[i - MINUTES_IN_WEEK];
+    }
+    for (int i = QUARTER_HOUR_TO_MINUTES; i < TARIFF_SUMS_LENGTH; i++){
+        tables->laterSums[i] += tables->laterSums[i - QUARTER_HOUR_TO_MINUTES];
+    }
+}
+
+
+/**
+ * @brief Parses the time of a window of a rule.
+ * 
+ * @param hour The hour (24 is allowed, for the end of a day).
+ * @param minute The minute.
+ * @param time Where to store the minute of the day.
+ * @return 1 if the time is valid, 0 otherwise.
+ */
+int parseRuleTime(int hour, int minute, int* time){
+    *time = hour * MINUTES_IN_HOUR + minute;
+    return hour >= 0 && minute >= 0 && minute < MINUTES_IN_HOUR &&
+            *time <= MINUTES_IN_DAY;
+}
+
+
+/**
+ * @brief Compiles the rules of a tariff (see tariff.h) into its tables.
+ * 
+ * The tables start with the tariff's own rates and maximum, and each rule
+ * overrides them in its days. A tariff without rules gets no tables, and
+ * so does one whose first word isn't "rate" or "cap": like before rules
+ * existed, trailing words are then ignored. If the rules can't be parsed,
+ * the tariff is marked invalid.
+ * 
+ * @param tariff Pointer to the tariff.
+ * @param rules The rules, separated by spaces.
+ */
+void compileTariffRules(Tariff* tariff, const char* rules){
+    char word[TARIFF_WORD_LENGTH], days[TARIFF_WORD_LENGTH];
+    int consumed = 0;
+
+    if (sscanf(rules, "%" TARIFF_WORD_WIDTH "s", word) != 1 ||
+        (strcmp(word, "rate") != 0 && strcmp(word, "cap") != 0)){
+        return;
+    }
+
+    TariffTables* tables = (TariffTables*)malloc(sizeof(TariffTables));
+    for (int minute = 0; minute < MINUTES_IN_WEEK; minute++){
+        tables->first[minute] = tariff->value15;
+        tables->laterSums[minute] = tariff->value15after1;
+    }
+    for (int day = 0; day < DAYS_IN_WEEK; day++){
+        tables->caps[day] = tariff->valueMaxDaily;
+    }
+
+    while (sscanf(rules, "%" TARIFF_WORD_WIDTH "s%n", word, &consumed) == 1){
+        int first, last, startHour, startMinute, endHour, endMinute;
+        int start, end;
+        double firstRate, laterRate, cap;
+
+        rules += consumed;
+        if (strcmp(word, "rate") == 0 &&
+            sscanf(rules, "%" TARIFF_WORD_WIDTH "s %d:%d-%d:%d%lf%lf%n",
+                    days, &startHour, &startMinute, &endHour, &endMinute,
+                    &firstRate, &laterRate, &consumed) == 7 &&
+            parseWeekdays(days, &first, &last) &&
+            parseRuleTime(startHour, startMinute, &start) &&
+            parseRuleTime(endHour, endMinute, &end) &&
+            firstRate >= 0 && laterRate >= 0){
+            setRates(tables, first, last, start % (MINUTES_IN_DAY), end,
+                        firstRate, laterRate);
+        }
+        else if (strcmp(word, "cap") == 0 &&
+            sscanf(rules, "%" TARIFF_WORD_WIDTH "s%lf%n", days, &cap,
+                    &consumed) == 2 &&
+            parseWeekdays(days, &first, &last) && cap > 0){
+            for (int day = first; ; day = (day + 1) % DAYS_IN_WEEK){
+                tables->caps[day] = cap;
+                if (day == last){
+                    break;
+                }
+            }
+        }
+        else {
+            free(tables);
+            tariff->invalidRules = 1;
+            return;
+        }
+        rules += consumed;
+    }
+
+    sumLaterRates(tables);
+    tariff->tables = tables;
+}
+
+
+/**
+ * @brief Frees the tables of a tariff.
+ * 
+ * @param tariff Pointer to the tariff.
+ */
+void freeTariff(Tariff* tariff){
+    free(tariff->tables);
+    tariff->tables = NULL;
+}
+
+
 /**
  * @brief Checks if a tariff is valid.
  * 
  * This function checks if the given tariff is valid, i.e., if the cost
  * values satisfy the conditions for a valid tariff:
  * value15 > value15after1 > valueMaxDaily > 0
+ * and if its rules were compiled.
  * 
  * @param tariff Pointer to the tariff to be validated.
  * @return 1 if the tariff is valid, otherwise 0.
@@ -44,17 +253,63 @@ int validTariff(const Tariff* tariff){
     return (
             tariff->value15 < tariff->value15after1 &&
             tariff->value15after1 < tariff->valueMaxDaily &&
-            tariff->value15 > 0  // therefore they all are > 0
+            tariff->value15 > 0 &&  // therefore they all are > 0
+            !tariff->invalidRules
             ) ? 1 : 0;           
 }
 
 
+/**
+ * @brief Calculates the cost of a stay from the compiled tables of a
+ * tariff.
+ * 
+ * @param tables Pointer to the tables of the tariff.
+ * @param entry Minute of the week of the entry.
+ * @param days Number of full days of stay.
+ * @param firstQuarters Quarters of the 1st hour after the full days.
+ * @param laterQuarters Later quarters after the full days.
+ * @return The cost of the stay.
+ */
+double tablesParkingCost(const TariffTables* tables, int entry, int days,
+int firstQuarters, int laterQuarters){
+    int weekday = entry / (MINUTES_IN_DAY);
+    double weekCaps = 0, cost;
+
+    // The full days: whole weeks, then the days left
+    for (int day = 0; day < DAYS_IN_WEEK; day++){
+        weekCaps += tables->caps[day];
+    }
+    cost = weekCaps * (days / DAYS_IN_WEEK);
+    for (int day = 0; day < days % DAYS_IN_WEEK; day++){
+        cost += tables->caps[(weekday + day) % DAYS_IN_WEEK];
+    }
+
+    // The quarters after the full days, up to the maximum of their day
+    int start = (entry + (days % DAYS_IN_WEEK) * (MINUTES_IN_DAY)) %
+                MINUTES_IN_WEEK;
+    double quarters = 0;
+    for (int i = 0; i < firstQuarters; i++){
+        quarters += tables->first[(start + i * QUARTER_HOUR_TO_MINUTES) %
+                                    MINUTES_IN_WEEK];
+    }
+    if (laterQuarters > 0){
+        int later = start + MAXIMUM_FIRST_HOUR_QUARTERS *
+                            QUARTER_HOUR_TO_MINUTES;
+        int lastLater = later + (laterQuarters - 1) * QUARTER_HOUR_TO_MINUTES;
+        quarters += tables->laterSums[lastLater] -
+                    tables->laterSums[later - QUARTER_HOUR_TO_MINUTES];
+    }
+    double cap = tables->caps[start / (MINUTES_IN_DAY)];
+    return cost + (quarters > cap ? cap : quarters);
+}
+
+
 /**
  * @brief Calculates the parking cost based on the tariff and timestamps.
  * 
  * This function calculates the parking cost based on the provided tariff
  * and entry/exit timestamps. It considers the duration of the parking and
- * applies the appropriate tariff rates.
+ * applies the appropriate tariff rates, in O(1).
  * 
  * @param tariff Pointer to the tariff instance.
  * @param entryTimestamp Pointer to the entry timestamp.
@@ -63,25 +318,21 @@ int validTariff(const Tariff* tariff){
  */
 double calculateParkingCost(const Tariff* tariff,
 const Timestamp* entryTimestamp, const Timestamp* exitTimestamp){
-    int days = 0, quarterHoursFirst = 0, quarterHoursAfterFirst = 0;
-
     // Find how many minutes the vehicle was in the park
     int minutesDiff = minutesDifference(entryTimestamp, exitTimestamp);
 
-    // Find how many full days to charge
-    while (minutesDiff >= (MINUTES_IN_DAY)){
-        days++;
-        minutesDiff -= (MINUTES_IN_DAY);
-    }
-    // Find how many quarter hours in the first hour to charge
-    while (minutesDiff > 0 && quarterHoursFirst < MAXIMUM_FIRST_HOUR_QUARTERS){
-        quarterHoursFirst++;
-        minutesDiff -= QUARTER_HOUR_TO_MINUTES;
-    }
-    // Find how many quarter hours after the first hour to charge
-    while (minutesDiff > 0) {
-        quarterHoursAfterFirst++;
-        minutesDiff -= QUARTER_HOUR_TO_MINUTES;
+    // Find how many full days to charge, and how many quarter hours (in
+    // the first hour and after it) of the rest
+    int days = minutesDiff / (MINUTES_IN_DAY);
+    int quarterHours = (minutesDiff % (MINUTES_IN_DAY) +
+                        QUARTER_HOUR_TO_MINUTES - 1) / QUARTER_HOUR_TO_MINUTES;
+    int quarterHoursFirst = quarterHours < MAXIMUM_FIRST_HOUR_QUARTERS ?
+                            quarterHours : MAXIMUM_FIRST_HOUR_QUARTERS;
+    int quarterHoursAfterFirst = quarterHours - quarterHoursFirst;
+
+    if (tariff->tables != NULL){
+        return tablesParkingCost(tariff->tables, minuteOfWeek(entryTimestamp),
+                        days, quarterHoursFirst, quarterHoursAfterFirst);
     }
 
     double totalQuartersPayment = tariff->value15 * quarterHoursFirst +
@@ -92,4 +343,4 @@ const Timestamp* entryTimestamp, const Timestamp* exitTimestamp){
         totalQuartersPayment = tariff->valueMaxDaily;
     }
     return totalQuartersPayment + tariff->valueMaxDaily * days;
-}
+}
\ No newline at end of file
@@ -3,6 +3,24 @@
  * 
  * Tariffs allow the storage of how much to charge for staying in a park.
  * 
+ * A tariff charges each full day (24 hours) of stay its maximum. The rest
+ * is charged by quarter hours, the ones of its first hour at one rate and
+ * the later ones at another, up to the maximum. Rules may change the rates
+ * in some hours of some weekdays (night or weekend rates) and the maximum
+ * of the days of stay starting on some weekdays:
+ * 
+ *   rate <days> <hh:mm>-<hh:mm> <1st hour rate> <later rate>
+ *   cap <days> <maximum>
+ * 
+ * where <days> is a weekday (mon, ..., sun), a range of them (mon-fri) or
+ * all. A window ending before its start ends on the next day, and later
+ * rules override earlier ones. A quarter is charged at the rates of the
+ * minute it starts.
+ * 
+ * The rules are compiled, once, into rates for every minute of the week,
+ * with prefix sums of the later quarters, so a stay costs O(1) lookups
+ * whatever its length. Tariffs without rules don't need the tables.
+ * 
  * Author: Adolfo Monteiro
 */
 #ifndef TARIFF_H
@@ -13,6 +31,19 @@
 // Maximum number of 15 minute periods to charge in the first hour
 #define MAXIMUM_FIRST_HOUR_QUARTERS 4
 #define QUARTER_HOUR_TO_MINUTES 15
+// Length of the prefix sums of the later quarters: a day of stay starts
+// anywhere in the week, and its later quarters span less than a day
+#define TARIFF_SUMS_LENGTH (MINUTES_IN_WEEK + MINUTES_IN_DAY)
+
+typedef struct tariffTables {
+    // Rate of a quarter of the 1st hour, by the minute of the week it starts
+    double first[MINUTES_IN_WEEK];
+    // Sum of the rates of the later quarters starting at a minute (of this
+    // and the next week) and every 15 minutes before it
+    double laterSums[TARIFF_SUMS_LENGTH];
+    // Maximum of a day of stay, by the weekday it starts
+    double caps[DAYS_IN_WEEK];
+} TariffTables;
 
 typedef struct tariff{
     // Value per 15 minutes in the 1st hour
@@ -21,11 +52,19 @@ typedef struct tariff{
     double value15after1;
     // Maximum value per day (24hours)
     double valueMaxDaily;
+    // Compiled rules, or NULL if the tariff has none
+    TariffTables* tables;
+    // 1 if the rules couldn't be compiled
+    int invalidRules;
 } Tariff;
 
 // Initializer
 Tariff newTariff(const double* value15, const double* value15after1,
 const double* valueMaxDaily);
+void compileTariffRules(Tariff* tariff, const char* rules);
+
+// Free
+void freeTariff(Tariff* tariff);
 
 // Validation
 int validTariff(const Tariff* tariff);
@@ -33,4 +72,4 @@ int validTariff(const Tariff* tariff);
 // Calculations
 double calculateParkingCost(const Tariff* tariff,
         const Timestamp* entryTimestamp, const Timestamp* exitTimestamp);
-#endif
\ No newline at end of file
+#endif
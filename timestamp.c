@@ -11,6 +11,8 @@
 
 // The number of days in each month of the year, february always has 28
 const int DAYS_IN_MONTH[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+// Weekday offset of each month in Sakamoto's method (real calendar)
+const int WEEKDAY_MONTH_OFFSETS[] = {0, 3, 2, 5, 0, 3, 5, 1, 4, 6, 2, 4};
 
 
 /**
@@ -155,7 +157,19 @@ int validTimestamp(const Timestamp* t){
  * @param t Pointer to the timestamp to be printed.
  */
 void printHourMinutes(const Timestamp *t){
-    printf("%02d:%02d", t->hour, t->minute);
+    fprintHourMinutes(stdout, t);
+}
+
+
+/**
+ * @brief Writes the hour and minute components of a timestamp to a stream,
+ * in the format "HH:MM".
+ * 
+ * @param stream The stream to write to.
+ * @param t Pointer to the timestamp to be written.
+ */
+void fprintHourMinutes(FILE* stream, const Timestamp *t){
+    fprintf(stream, "%02d:%02d", t->hour, t->minute);
 }
 
 
@@ -168,7 +182,19 @@ void printHourMinutes(const Timestamp *t){
  * @param t Pointer to the timestamp to be printed.
  */
 void printDate(const Timestamp *t){
-    printf("%02d-%02d-%d", t->day, t->month, t->year);
+    fprintDate(stdout, t);
+}
+
+
+/**
+ * @brief Writes the date components of a timestamp to a stream, in the
+ * format "DD-MM-YYYY".
+ * 
+ * @param stream The stream to write to.
+ * @param t Pointer to the timestamp to be written.
+ */
+void fprintDate(FILE* stream, const Timestamp *t){
+    fprintf(stream, "%02d-%02d-%d", t->day, t->month, t->year);
 }
 
 
@@ -181,10 +207,22 @@ void printDate(const Timestamp *t){
  * @param t Pointer to the timestamp to be printed.
  */
 void printTimestamp(const Timestamp *t){
+    fprintTimestamp(stdout, t);
+}
+
+
+/**
+ * @brief Writes the full timestamp to a stream, in the format
+ * "DD-MM-YYYY HH:MM".
+ * 
+ * @param stream The stream to write to.
+ * @param t Pointer to the timestamp to be written.
+ */
+void fprintTimestamp(FILE* stream, const Timestamp *t){
     // no newline
-    printDate(t);
-    printf(" ");
-    printHourMinutes(t);
+    fprintDate(stream, t);
+    fprintf(stream, " ");
+    fprintHourMinutes(stream, t);
 }
 
 
@@ -217,4 +255,40 @@ int timestampToMinutes(const Timestamp *t){
  */
 int minutesDifference(const Timestamp *t1, const Timestamp *t2){
     return timestampToMinutes(t2) - timestampToMinutes(t1);
-}
\ No newline at end of file
+}
+
+
+/**
+ * @brief Calculates the weekday of a timestamp's date.
+ * 
+ * The weekday is the one of the real (Gregorian) calendar, found with
+ * Sakamoto's method, even though durations are counted without leap years.
+ * 
+ * @param t Pointer to the timestamp.
+ * @return The weekday, 0 being Monday.
+ */
+int timestampWeekday(const Timestamp* t){
+    // January and February count as months of the year before
+    int year = t->year - (t->month < 3);
+    int sunday = (year + year / 4 - year / 100 + year / 400 +
+                    WEEKDAY_MONTH_OFFSETS[t->month - 1] + t->day) %
+                    DAYS_IN_WEEK;
+
+    // Years aren't validated: keep the weekday in the week even before 0001
+    if (sunday < 0){
+        sunday += DAYS_IN_WEEK;
+    }
+    return (sunday + DAYS_IN_WEEK - 1) % DAYS_IN_WEEK;
+}
+
+
+/**
+ * @brief Calculates the minute of the week of a timestamp.
+ * 
+ * @param t Pointer to the timestamp.
+ * @return The minutes since the Monday at 00:00 before the timestamp.
+ */
+int minuteOfWeek(const Timestamp* t){
+    return timestampWeekday(t) * MINUTES_IN_DAY +
+            t->hour * MINUTES_IN_HOUR + t->minute;
+}
@@ -8,11 +8,15 @@
 #ifndef TIMESTAMP_H
 #define TIMESTAMP_H
 
+#include <stdio.h>
+
 // Default value for a timestamp when unsure of what value to specify
 #define INITIAL_TIMESTAMP ((Timestamp){0, 0, 0, 0, 0})
 #define DAYS_IN_YEAR 365
 #define MINUTES_IN_DAY 24*60
 #define MINUTES_IN_HOUR 60
+#define DAYS_IN_WEEK 7
+#define MINUTES_IN_WEEK (DAYS_IN_WEEK * 24 * 60)
 
 
 typedef struct timestamp{
@@ -36,8 +40,13 @@ void printHourMinutes(const Timestamp* t);
 // Prints
 void printDate(const Timestamp* t);
 void printTimestamp(const Timestamp* t);
+void fprintHourMinutes(FILE* stream, const Timestamp* t);
+void fprintDate(FILE* stream, const Timestamp* t);
+void fprintTimestamp(FILE* stream, const Timestamp* t);
 
 // Convertions to minutes
 int timestampToMinutes(const Timestamp* t);
 int minutesDifference(const Timestamp* t1, const Timestamp* t2);
+int timestampWeekday(const Timestamp* t);
+int minuteOfWeek(const Timestamp* t);
 #endif
\ No newline at end of file
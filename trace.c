@@ -0,0 +1,240 @@
+/**
+ * Implementation of the functions related to the tracer.
+ *
+ * The tracer records spans in a ring buffer and writes them as Chrome
+ * trace-event JSON.
+ *
+ * Author: Adolfo Monteiro
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#include "trace.h"
+
+// Names of the spans of each command, by command letter
+const char* COMMAND_SPAN_NAMES[] = {
+    ['p'] = "command p", ['e'] = "command e", ['s'] = "command s",
+    ['v'] = "command v", ['f'] = "command f", ['r'] = "command r",
+    ['i'] = "command i", ['d'] = "command d", ['o'] = "command o",
+    ['u'] = "command u", ['w'] = "command w", ['n'] = "command n",
+    ['a'] = "command a", ['g'] = "command g", ['c'] = "command c",
+    ['x'] = "command x", ['q'] = "command q", ['z'] = NULL
+};
+
+
+/**
+ * @brief Reads the monotonic clock.
+ *
+ * @return The clock reading, in nanoseconds.
+ */
+unsigned long long clockNanoseconds(){
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+
+/**
+ * @brief Creates a new tracer, with an empty ring buffer.
+ *
+ * @param aggregate 1 to aggregate the spans of the calling thread by name,
+ * with its hardware counters if they can be opened, 0 otherwise.
+ * @return Pointer to the new tracer.
+ */
+Tracer* newTracer(int aggregate){
+    Tracer* tracer = (Tracer*)malloc(sizeof(Tracer));
+
+    tracer->spans = (TraceSpan*)malloc(TRACE_CAPACITY * sizeof(TraceSpan));
+    atomic_init(&tracer->numSpans, 0);
+    tracer->origin = clockNanoseconds();
+    tracer->owner = pthread_self();
+    tracer->aggregate = aggregate;
+    tracer->counters = aggregate ? openCounters() : NULL;
+    tracer->numStats = 0;
+
+    return tracer;
+}
+
+
+/**
+ * @brief Frees the memory allocated for a tracer.
+ *
+ * @param tracer Pointer to the tracer, or NULL.
+ */
+void freeTracer(Tracer* tracer){
+    if (tracer != NULL){
+        closeCounters(tracer->counters);
+        free(tracer->spans);
+        free(tracer);
+    }
+}
+
+
+/**
+ * @brief Checks if the calling thread's spans are aggregated with hardware
+ * counters.
+ *
+ * @param tracer Pointer to the tracer.
+ * @return 1 if they are, 0 otherwise.
+ */
+int readsCounters(const Tracer* tracer){
+    return tracer->counters != NULL && ownsCounters(tracer->counters);
+}
+
+
+/**
+ * @brief Starts a span.
+ *
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
+ * @return The start of the span, to be given to traceEnd.
+ */
+SpanStart traceBegin(const Tracer* tracer){
+    SpanStart start = {0, {0}};
+
+    if (tracer != NULL){
+        if (readsCounters(tracer)){
+            readCounters(tracer->counters, start.counters);
+        }
+        start.time = clockNanoseconds() - tracer->origin;
+    }
+    return start;
+}
+
+
+/**
+ * @brief Adds a span of the owner thread to the stats of its name.
+ *
+ * @param tracer Pointer to the tracer.
+ * @param name String literal naming the span.
+ * @param start Pointer to the start of the span.
+ * @param end Pointer to the end of the span.
+ */
+void aggregateSpan(Tracer* tracer, const char* name, const SpanStart* start,
+const SpanStart* end){
+    unsigned int i = 0;
+
+    while (i < tracer->numStats && strcmp(tracer->stats[i].name, name) != 0){
+        i++;
+    }
+    if (i == tracer->numStats){
+        if (i == MAX_SPAN_NAMES){
+            return;
+        }
+        memset(&tracer->stats[i], 0, sizeof(SpanStats));
+        tracer->stats[i].name = name;
+        tracer->numStats++;
+    }
+
+    SpanStats* stats = &tracer->stats[i];
+    stats->count++;
+    stats->time += end->time - start->time;
+    for (int c = 0; c < NUM_COUNTERS; c++){
+        stats->counters[c] += end->counters[c] - start->counters[c];
+    }
+}
+
+
+/**
+ * @brief Ends a span, recording it over the oldest one if the ring buffer
+ * is full.
+ *
+ * Safe to call from several threads at once.
+ *
+ * @param tracer Pointer to the tracer, or NULL if tracing is disabled.
+ * @param name String literal naming the span.
+ * @param start Pointer to the start of the span, as returned by traceBegin.
+ */
+void traceEnd(Tracer* tracer, const char* name, const SpanStart* start){
+    if (tracer == NULL){
+        return;
+    }
+    SpanStart end = {clockNanoseconds() - tracer->origin, {0}};
+    unsigned long index = atomic_fetch_add(&tracer->numSpans, 1);
+    TraceSpan* span = &tracer->spans[index & (TRACE_CAPACITY - 1)];
+
+    span->name = name;
+    span->start = start->time;
+    span->duration = end.time - start->time;
+    span->thread = (unsigned int)syscall(SYS_gettid);
+
+    // Only the owner's spans are aggregated, as only it reads the counters
+    if (tracer->aggregate && pthread_equal(pthread_self(), tracer->owner)){
+        if (readsCounters(tracer)){
+            readCounters(tracer->counters, end.counters);
+        }
+        aggregateSpan(tracer, name, start, &end);
+    }
+}
+
+
+/**
+ * @brief Retrieves the name of the span of a command.
+ *
+ * @param command The command letter.
+ * @return The name of the span.
+ */
+const char* commandSpanName(char command){
+    if (command >= 'a' && command <= 'z' &&
+        COMMAND_SPAN_NAMES[(int)command] != NULL){
+        return COMMAND_SPAN_NAMES[(int)command];
+    }
+    return "command ?";
+}
+
+
+/**
+ * @brief Writes the spans in the ring buffer as Chrome trace-event JSON.
+ *
+ * @param tracer Pointer to the tracer.
+ * @param file The file to write to.
+ */
+void writeTrace(const Tracer* tracer, FILE* file){
+    unsigned long numSpans = atomic_load(&tracer->numSpans);
+    unsigned long first = (numSpans > TRACE_CAPACITY) ?
+                            numSpans - TRACE_CAPACITY : 0;
+
+    fprintf(file, "{\"traceEvents\":[");
+    for (unsigned long i = first; i < numSpans; i++){
+        const TraceSpan* span = &tracer->spans[i & (TRACE_CAPACITY - 1)];
+        fprintf(file, "%s\n{\"name\":\"%s\",\"cat\":\"parks\",\"ph\":\"X\","
+            "\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+            (i == first) ? "" : ",", span->name,
+            span->start / NANOSECONDS_IN_MICROSECOND,
+            span->duration / NANOSECONDS_IN_MICROSECOND, span->thread);
+    }
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+}
+
+
+/**
+ * @brief Writes the aggregated stats of each span name, as a table.
+ *
+ * Spans nest (a command's span includes its phases), so the rows don't
+ * add up.
+ *
+ * @param tracer Pointer to the tracer.
+ * @param file The file to write to.
+ */
+void writeSpanStats(const Tracer* tracer, FILE* file){
+    if (tracer->counters == NULL){
+        fprintf(file, "hardware counters unavailable\n");
+    }
+    fprintf(file, "%-16s %10s %14s", "span", "count", "ns");
+    for (int c = 0; c < NUM_COUNTERS; c++){
+        fprintf(file, " %14s", getCounterName(c));
+    }
+    fprintf(file, "\n");
+
+    for (unsigned int i = 0; i < tracer->numStats; i++){
+        const SpanStats* stats = &tracer->stats[i];
+        fprintf(file, "%-16s %10llu %14llu", stats->name, stats->count,
+                stats->time);
+        for (int c = 0; c < NUM_COUNTERS; c++){
+            fprintf(file, " %14llu", stats->counters[c]);
+        }
+        fprintf(file, "\n");
+    }
+}
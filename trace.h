@@ -0,0 +1,79 @@
+/**
+ * Definition of the tracer structs, and of the function prototypes related
+ * to them.
+ *
+ * The tracer records spans (a name, the thread, a start and a duration) in
+ * a ring buffer, keeping the most recent ones, and writes them as Chrome
+ * trace-event JSON, which Perfetto and chrome://tracing can show. A NULL
+ * tracer records nothing, so tracing costs a pointer test when disabled.
+ *
+ * The tracer can also aggregate, by span name, the spans of the thread
+ * that created it: their count, time and hardware counters (see
+ * counters.h), which are read at the start and end of each span.
+ *
+ * Author: Adolfo Monteiro
+*/
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include "counters.h"
+
+// Number of spans kept by the ring buffer (must be a power of 2)
+#define TRACE_CAPACITY (1 << 18)
+// Nanoseconds in a microsecond (the unit of the trace-event format)
+#define NANOSECONDS_IN_MICROSECOND 1000.0
+// Maximum number of distinct span names aggregated
+#define MAX_SPAN_NAMES 64
+
+typedef struct traceSpan {
+    const char* name; // string literal naming the span
+    unsigned long long start; // nanoseconds since the tracer was created
+    unsigned long long duration; // in nanoseconds
+    unsigned int thread; // id of the thread that ran the span
+} TraceSpan;
+
+typedef struct spanStart {
+    unsigned long long time; // nanoseconds since the tracer was created
+    unsigned long long counters[NUM_COUNTERS]; // counters at the start
+} SpanStart;
+
+typedef struct spanStats {
+    const char* name;
+    unsigned long long count; // spans with this name
+    unsigned long long time; // total nanoseconds
+    unsigned long long counters[NUM_COUNTERS]; // totals of each counter
+} SpanStats;
+
+typedef struct tracer {
+    TraceSpan* spans; // ring buffer of TRACE_CAPACITY spans
+    atomic_ulong numSpans; // spans ever recorded
+    unsigned long long origin; // clock reading when the tracer was created
+    pthread_t owner; // thread whose spans are aggregated
+    int aggregate; // 1 if spans are aggregated by name
+    Counters* counters; // hardware counters, or NULL if not read
+    SpanStats stats[MAX_SPAN_NAMES];
+    unsigned int numStats;
+} Tracer;
+
+
+// Initializer
+Tracer* newTracer(int aggregate);
+
+// Free
+void freeTracer(Tracer* tracer);
+
+// Clock
+unsigned long long clockNanoseconds();
+
+// Recording
+SpanStart traceBegin(const Tracer* tracer);
+void traceEnd(Tracer* tracer, const char* name, const SpanStart* start);
+const char* commandSpanName(char command);
+
+// Writing
+void writeTrace(const Tracer* tracer, FILE* file);
+void writeSpanStats(const Tracer* tracer, FILE* file);
+#endif